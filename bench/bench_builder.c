@@ -0,0 +1,117 @@
+#include "../src/sds011_builder.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ITERATIONS  (4 * 1000 * 1000)
+#define MAX_THREADS 64
+#define FLEET_SIZE  4096
+#define FLEET_REPEAT 1000
+
+typedef struct {
+  uint16_t id;
+  uint32_t checksum;
+} worker_t;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void *worker(void *arg) {
+  worker_t *w = arg;
+  uint8_t buffer[SDS011_QUERY_PACKET_SIZE];
+  sds011_err_t err;
+
+  sds011_msg_t msg = {
+    .dev_id = w->id,
+    .type   = SDS011_MSG_TYPE_OP_MODE,
+    .op     = SDS011_MSG_OP_SET,
+    .src    = SDS011_MSG_SRC_HOST,
+    .data.op_mode.mode = SDS011_OP_MODE_INTERVAL,
+  };
+
+  // Accumulated locally, workers share cache lines
+  uint32_t checksum = 0;
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    msg.data.op_mode.interval = (uint8_t)(i % 31);
+    if (sds011_builder_build_r(&msg, buffer, sizeof(buffer), &err) != 0) {
+      checksum += buffer[17];
+    }
+  }
+  w->checksum = checksum;
+  return NULL;
+}
+
+// Same command for a whole fleet, built once and patched per device
+static void bench_fleet(void) {
+  static uint16_t dev_ids[FLEET_SIZE];
+  static uint8_t buffer[FLEET_SIZE * SDS011_QUERY_PACKET_SIZE];
+  uint32_t checksum = 0;
+
+  for (size_t i = 0; i < FLEET_SIZE; i++) {
+    dev_ids[i] = (uint16_t)(i * 2654435761u);
+  }
+
+  sds011_msg_t msg = {
+    .type   = SDS011_MSG_TYPE_OP_MODE,
+    .op     = SDS011_MSG_OP_SET,
+    .src    = SDS011_MSG_SRC_HOST,
+    .data.op_mode = { SDS011_OP_MODE_INTERVAL, 5 },
+  };
+
+  double beg = now_ns();
+  for (int r = 0; r < FLEET_REPEAT; r++) {
+    sds011_builder_build_fleet(&msg, dev_ids, FLEET_SIZE, buffer, sizeof(buffer), NULL);
+    checksum += buffer[(size_t)r % sizeof(buffer)];
+  }
+  double elapsed = now_ns() - beg;
+
+  printf("fleet     %8.3f ns/frame (%u)\n",
+    elapsed / ((double)FLEET_SIZE * FLEET_REPEAT), checksum & 1);
+}
+
+// Every thread builds the same number of messages, with linear scaling
+// the rate grows with the number of threads up to the number of cores.
+// The maximum number of threads defaults to the number of cores and can
+// be given as the first argument.
+int main(int argc, char **argv) {
+  long cores = argc > 1 ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+  size_t max_threads = cores > 0 ? (size_t)cores : 1;
+  if (max_threads > MAX_THREADS) {
+    max_threads = MAX_THREADS;
+  }
+
+  pthread_t threads[MAX_THREADS];
+  worker_t workers[MAX_THREADS];
+  double single = 0;
+
+  for (size_t count = 1; count <= max_threads; count *= 2) {
+    double beg = now_ns();
+    for (size_t i = 0; i < count; i++) {
+      workers[i] = (worker_t) { .id = (uint16_t)i, .checksum = 0 };
+      if (pthread_create(&threads[i], NULL, worker, &workers[i]) != 0) {
+        return 1;
+      }
+    }
+    for (size_t i = 0; i < count; i++) {
+      pthread_join(threads[i], NULL);
+    }
+    double rate = (double)ITERATIONS * (double)count * 1e9 / (now_ns() - beg);
+    if (count == 1) {
+      single = rate;
+    }
+    printf("%3zu threads %12.0f msgs/s %6.2fx\n", count, rate, rate / single);
+
+    if (count < max_threads && count * 2 > max_threads) {
+      count = max_threads / 2;
+    }
+  }
+
+  bench_fleet();
+  return 0;
+}
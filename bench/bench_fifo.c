@@ -0,0 +1,213 @@
+#include "../src/sds011.h"
+#include "../src/sds011_fifo.h"
+#include "../src/sds011_spsc_fifo.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#define TRANSFERS (4 * 1000 * 1000)
+#define BATCH     16
+
+typedef struct {
+  sds011_fifo_t fifo;
+  pthread_mutex_t lock;
+} locked_fifo_t;
+
+static locked_fifo_t locked;
+static sds011_spsc_fifo_t spsc;
+static sds011_request_t mem[SDS011_REQ_QUEUE_SIZE * 8];
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool locked_push(void const *el) {
+  pthread_mutex_lock(&locked.lock);
+  bool res = sds011_fifo_push(&locked.fifo, el);
+  pthread_mutex_unlock(&locked.lock);
+  return res;
+}
+
+static bool locked_pop(void *el) {
+  pthread_mutex_lock(&locked.lock);
+  bool res = sds011_fifo_pop(&locked.fifo, el);
+  pthread_mutex_unlock(&locked.lock);
+  return res;
+}
+
+static void *locked_producer(void *arg) {
+  sds011_request_t req = { .msg.dev_id = 1 };
+  (void)arg;
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    req.msg.data.new_dev_id = (uint16_t)i;
+    if (locked_push(&req) == false) {
+      sched_yield();
+      continue;
+    }
+    i++;
+  }
+  return NULL;
+}
+
+static void *spsc_producer(void *arg) {
+  sds011_request_t req = { .msg.dev_id = 1 };
+  (void)arg;
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    req.msg.data.new_dev_id = (uint16_t)i;
+    if (sds011_spsc_fifo_push(&spsc, &req) == false) {
+      sched_yield();
+      continue;
+    }
+    i++;
+  }
+  return NULL;
+}
+
+static void *spsc_batch_producer(void *arg) {
+  sds011_request_t reqs[BATCH] = { 0 };
+  (void)arg;
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    size_t n = TRANSFERS - i < BATCH ? TRANSFERS - i : BATCH;
+    for (size_t j = 0; j < n; j++) {
+      reqs[j].msg.data.new_dev_id = (uint16_t)(i + j);
+    }
+    size_t pushed = sds011_spsc_fifo_push_n(&spsc, reqs, n);
+    if (pushed == 0) {
+      sched_yield();
+    }
+    i += (uint32_t)pushed;
+  }
+  return NULL;
+}
+
+static void report(char const *name, double elapsed, uint32_t checksum) {
+  printf("%-12s %8.2f ns/request %8.2f M requests/s (%u)\n", name,
+    elapsed / TRANSFERS, TRANSFERS / elapsed * 1e3, checksum & 1);
+}
+
+// Request queue of sds011_t filled and drained on one thread, the generic
+// fifo against the typed ring, with copies and in place.
+static void bench_queue(void) {
+  static sds011_request_t fifo_mem[SDS011_REQ_QUEUE_SIZE + 1];
+  static sds011_fifo_t fifo;
+  static sds011_req_ring_t ring;
+  sds011_request_t req = { .msg.dev_id = 1 };
+  uint32_t checksum;
+  double beg;
+
+  sds011_fifo_init(&fifo, sizeof(sds011_request_t), fifo_mem, sizeof(fifo_mem));
+
+  checksum = 0;
+  beg = now_ns();
+  for (uint32_t i = 0; i < TRANSFERS; i += SDS011_REQ_QUEUE_SIZE) {
+    for (uint32_t j = 0; j < SDS011_REQ_QUEUE_SIZE; j++) {
+      req.msg.data.new_dev_id = (uint16_t)(i + j);
+      sds011_fifo_push(&fifo, &req);
+    }
+    while (sds011_fifo_pop(&fifo, &req)) {
+      checksum += req.msg.data.new_dev_id;
+    }
+  }
+  report("fifo", now_ns() - beg, checksum);
+
+  sds011_req_ring_init(&ring, SDS011_REQ_QUEUE_SIZE);
+
+  checksum = 0;
+  beg = now_ns();
+  for (uint32_t i = 0; i < TRANSFERS; i += SDS011_REQ_QUEUE_SIZE) {
+    for (uint32_t j = 0; j < SDS011_REQ_QUEUE_SIZE; j++) {
+      req.msg.data.new_dev_id = (uint16_t)(i + j);
+      sds011_req_ring_push(&ring, &req);
+    }
+    while (sds011_req_ring_pop(&ring, &req)) {
+      checksum += req.msg.data.new_dev_id;
+    }
+  }
+  report("ring", now_ns() - beg, checksum);
+
+  checksum = 0;
+  beg = now_ns();
+  for (uint32_t i = 0; i < TRANSFERS; i += SDS011_REQ_QUEUE_SIZE) {
+    for (uint32_t j = 0; j < SDS011_REQ_QUEUE_SIZE; j++) {
+      sds011_request_t *slot = sds011_req_ring_reserve(&ring);
+      slot->msg.dev_id = 1;
+      slot->msg.data.new_dev_id = (uint16_t)(i + j);
+      sds011_req_ring_commit(&ring);
+    }
+    sds011_request_t const *head;
+    while ((head = sds011_req_ring_peek(&ring)) != NULL) {
+      checksum += head->msg.data.new_dev_id;
+      sds011_req_ring_release(&ring);
+    }
+  }
+  report("ring inplace", now_ns() - beg, checksum);
+}
+
+// After the single thread queue benchmark, requests are handed from a
+// producer thread to the main thread. Both sides yield when the fifo is
+// full or empty, so the benchmark also runs on a single core.
+int main(void) {
+  sds011_request_t req;
+  sds011_request_t reqs[BATCH];
+  pthread_t thread;
+  uint32_t checksum;
+  double beg;
+
+  bench_queue();
+
+  sds011_fifo_init(&locked.fifo, sizeof(sds011_request_t), mem, sizeof(mem));
+  pthread_mutex_init(&locked.lock, NULL);
+
+  checksum = 0;
+  beg = now_ns();
+  pthread_create(&thread, NULL, locked_producer, NULL);
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    if (locked_pop(&req) == false) {
+      sched_yield();
+      continue;
+    }
+    checksum += req.msg.data.new_dev_id;
+    i++;
+  }
+  pthread_join(thread, NULL);
+  report("mutex", now_ns() - beg, checksum);
+
+  sds011_spsc_fifo_init(&spsc, sizeof(sds011_request_t), mem, sizeof(mem));
+
+  checksum = 0;
+  beg = now_ns();
+  pthread_create(&thread, NULL, spsc_producer, NULL);
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    if (sds011_spsc_fifo_pop(&spsc, &req) == false) {
+      sched_yield();
+      continue;
+    }
+    checksum += req.msg.data.new_dev_id;
+    i++;
+  }
+  pthread_join(thread, NULL);
+  report("spsc", now_ns() - beg, checksum);
+
+  checksum = 0;
+  beg = now_ns();
+  pthread_create(&thread, NULL, spsc_batch_producer, NULL);
+  for (uint32_t i = 0; i < TRANSFERS; ) {
+    size_t n = sds011_spsc_fifo_pop_n(&spsc, reqs, BATCH);
+    if (n == 0) {
+      sched_yield();
+    }
+    for (size_t j = 0; j < n; j++) {
+      checksum += reqs[j].msg.data.new_dev_id;
+    }
+    i += (uint32_t)n;
+  }
+  pthread_join(thread, NULL);
+  report("spsc batch", now_ns() - beg, checksum);
+
+  pthread_mutex_destroy(&locked.lock);
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include "../src/sds011_parser.h"
+#include "../src/sds011_builder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(SDS011_PARSER_TABLE)
+#define PARSER_CORE "table"
+#else
+#define PARSER_CORE "switch"
+#endif
+
+#define STREAM_SIZE (1024 * 1024)
+#define REPEAT      32
+#define MSGS_COUNT  64
+
+typedef struct {
+  char const *name;
+  size_t (*build)(uint8_t *buf, size_t size);
+  bool resync;
+} scenario_t;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static sds011_msg_t data_msg(uint16_t iter) {
+  return (sds011_msg_t) {
+    .dev_id             = (uint16_t)(0xA000 + (iter & 0xFF)),
+    .type               = SDS011_MSG_TYPE_DATA,
+    .op                 = SDS011_MSG_OP_GET,
+    .src                = SDS011_MSG_SRC_SENSOR,
+    .data.sample.pm2_5  = (uint16_t)(iter * 7),
+    .data.sample.pm10   = (uint16_t)(iter * 13),
+  };
+}
+
+// Stream of data replies only, as sent in active reporting mode
+static size_t build_valid(uint8_t *buf, size_t size) {
+  size_t len = 0;
+  uint16_t iter = 0;
+
+  while (len + SDS011_QUERY_PACKET_SIZE <= size) {
+    sds011_msg_t msg = data_msg(iter++);
+    len += sds011_builder_build(&msg, &buf[len], size - len);
+  }
+  return len;
+}
+
+// Data replies with noise bytes between packets and corrupted packets
+static size_t build_noise(uint8_t *buf, size_t size) {
+  size_t len = 0;
+  uint16_t iter = 0;
+  uint32_t seed = 1;
+
+  while (len + 2 * SDS011_QUERY_PACKET_SIZE <= size) {
+    sds011_msg_t msg = data_msg(iter++);
+    size_t beg = len;
+    len += sds011_builder_build(&msg, &buf[len], size - len);
+
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 8 == 0) {
+      buf[beg + 2 + (seed >> 20) % 8] ^= (uint8_t)(seed >> 8) | 1;
+    }
+    for (uint32_t n = (seed >> 24) % 4; n > 0; n--) {
+      seed = seed * 1103515245 + 12345;
+      buf[len++] = (uint8_t)(seed >> 16);
+    }
+  }
+  return len;
+}
+
+// Stream of data replies with every 8th packet being a query or a reply
+static size_t build_mixed(uint8_t *buf, size_t size) {
+  size_t len = 0;
+  uint16_t iter = 0;
+
+  while (len + SDS011_QUERY_PACKET_SIZE <= size) {
+    sds011_msg_t msg = data_msg(iter);
+    if ((iter & 7) == 3) {
+      msg.src = SDS011_MSG_SRC_HOST;
+    }
+    if ((iter & 7) == 5) {
+      msg.type = SDS011_MSG_TYPE_SLEEP;
+      msg.op = SDS011_MSG_OP_SET;
+      msg.data.sleep = SDS011_SLEEP_OFF;
+    }
+    len += sds011_builder_build(&msg, &buf[len], size - len);
+    iter++;
+  }
+  return len;
+}
+
+static void report(char const *scenario, char const *api, size_t len,
+                   size_t frames, double elapsed) {
+  printf("%-8s %-6s %-6s %8.3f ns/byte %12.0f frames/s (%zu frames)\n",
+    PARSER_CORE, scenario, api, elapsed / ((double)len * REPEAT),
+    (double)frames * 1e9 / elapsed, frames);
+}
+
+static void bench_bytes(scenario_t const *sc, uint8_t const *buf, size_t len) {
+  sds011_parser_t parser;
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, sc->resync);
+
+  size_t frames = 0;
+  double beg = now_ns();
+  for (int r = 0; r < REPEAT; r++) {
+    for (size_t i = 0; i < len; i++) {
+      if (sds011_parser_parse(&parser, buf[i]) == SDS011_PARSER_RES_READY) {
+        frames++;
+      }
+    }
+  }
+  report(sc->name, "byte", len, frames, now_ns() - beg);
+}
+
+static void bench_buffer(scenario_t const *sc, uint8_t const *buf, size_t len) {
+  sds011_parser_t parser;
+  sds011_msg_t msgs[MSGS_COUNT];
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, sc->resync);
+
+  size_t frames = 0;
+  double beg = now_ns();
+  for (int r = 0; r < REPEAT; r++) {
+    size_t iter = 0;
+    while (iter < len) {
+      size_t consumed;
+      frames += sds011_parser_parse_buffer(&parser, &buf[iter], len - iter,
+                                           msgs, MSGS_COUNT, &consumed);
+      iter += consumed;
+    }
+  }
+  report(sc->name, "buffer", len, frames, now_ns() - beg);
+}
+
+static const scenario_t _scenarios[] = {
+  { "valid", build_valid, false },
+  { "noise", build_noise, true  },
+  { "mixed", build_mixed, false },
+};
+
+int main(void) {
+  uint8_t *buf = malloc(STREAM_SIZE);
+  if (buf == NULL) {
+    return 1;
+  }
+
+  for (size_t i = 0; i < sizeof(_scenarios) / sizeof(_scenarios[0]); i++) {
+    size_t len = _scenarios[i].build(buf, STREAM_SIZE);
+    bench_bytes(&_scenarios[i], buf, len);
+    bench_buffer(&_scenarios[i], buf, len);
+  }
+
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include "../src/sds011_scanner.h"
+#include "../src/sds011_builder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__AVX2__)
+#define SCANNER_ISA "avx2"
+#elif defined(__SSE2__)
+#define SCANNER_ISA "sse2"
+#else
+#define SCANNER_ISA "scalar"
+#endif
+
+#define STREAM_SIZE   (1024 * 1024)
+#define REPEAT        32
+#define OFFSETS_COUNT 256
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Data replies, as sent in active reporting mode, every 8th one corrupted
+static size_t build_stream(uint8_t *buf, size_t size) {
+  size_t len = 0;
+  uint16_t iter = 0;
+
+  while (len + SDS011_REPLY_PACKET_SIZE <= size) {
+    size_t beg = len;
+    len += sds011_builder_build(&(sds011_msg_t) {
+      .dev_id             = (uint16_t)(0xA000 + (iter & 0xFF)),
+      .type               = SDS011_MSG_TYPE_DATA,
+      .op                 = SDS011_MSG_OP_GET,
+      .src                = SDS011_MSG_SRC_SENSOR,
+      .data.sample.pm2_5  = (uint16_t)(iter * 7),
+      .data.sample.pm10   = (uint16_t)(iter * 13),
+    }, &buf[len], size - len);
+    if ((iter++ & 7) == 0) {
+      buf[beg + SDS011_REPLY_PACKET_SIZE - 2] ^= 1;
+    }
+  }
+  return len;
+}
+
+static void report(char const *api, size_t frames, double elapsed) {
+  printf("%-6s %-8s %8.3f ns/frame (%zu frames)\n",
+    SCANNER_ISA, api, elapsed / (double)frames, frames);
+}
+
+// Candidates checked one at a time
+static void bench_check(uint8_t const *buf, size_t len) {
+  size_t frames = 0;
+  double beg = now_ns();
+  for (int r = 0; r < REPEAT; r++) {
+    size_t iter = 0;
+    while ((iter += sds011_scanner_find(&buf[iter], len - iter)) < len) {
+      if (sds011_scanner_check(&buf[iter], len - iter) == SDS011_OK) {
+        frames++;
+        iter += SDS011_REPLY_PACKET_SIZE;
+      } else {
+        iter++;
+      }
+    }
+  }
+  report("check", frames, now_ns() - beg);
+}
+
+// Candidates checked in batches
+static void bench_scan(uint8_t const *buf, size_t len) {
+  size_t offsets[OFFSETS_COUNT];
+  size_t frames = 0;
+  double beg = now_ns();
+  for (int r = 0; r < REPEAT; r++) {
+    size_t iter = 0;
+    while (iter < len) {
+      size_t consumed;
+      frames += sds011_scanner_scan(&buf[iter], len - iter, offsets, OFFSETS_COUNT, &consumed);
+      if (consumed == 0) {
+        break;
+      }
+      iter += consumed;
+    }
+  }
+  report("scan", frames, now_ns() - beg);
+}
+
+int main(void) {
+  uint8_t *buf = malloc(STREAM_SIZE);
+  if (buf == NULL) {
+    return 1;
+  }
+
+  size_t len = build_stream(buf, STREAM_SIZE);
+  bench_check(buf, len);
+  bench_scan(buf, len);
+
+  free(buf);
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "../src/sds011_parser.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MSGS_COUNT 8
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size);
+
+// Byte by byte parsing and buffer parsing have to find the same packets,
+// in every parser mode.
+static size_t parse_bytes(uint8_t const *data, size_t size, bool resync, bool lazy) {
+  sds011_parser_t parser;
+  sds011_msg_t msg;
+  size_t ready = 0;
+
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, resync);
+  sds011_parser_set_lazy(&parser, lazy);
+
+  for (size_t i = 0; i < size; i++) {
+    switch (sds011_parser_parse(&parser, data[i])) {
+      case SDS011_PARSER_RES_READY:
+        sds011_parser_get_msg(&parser, &msg);
+        if (msg.type >= SDS011_MSG_TYPE_COUNT) {
+          __builtin_trap();
+        }
+        ready++;
+        break;
+      case SDS011_PARSER_RES_ERROR:
+        if (sds011_parser_get_error(&parser) == SDS011_OK) {
+          __builtin_trap();
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return ready;
+}
+
+static size_t parse_buffer(uint8_t const *data, size_t size, bool resync) {
+  sds011_parser_t parser;
+  sds011_msg_t msgs[MSGS_COUNT];
+  size_t ready = 0;
+  size_t iter = 0;
+
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, resync);
+
+  while (iter < size) {
+    size_t consumed;
+    ready += sds011_parser_parse_buffer(&parser, &data[iter], size - iter,
+                                        msgs, MSGS_COUNT, &consumed);
+    if (consumed == 0) {
+      __builtin_trap();
+    }
+    iter += consumed;
+  }
+  return ready;
+}
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size) {
+  for (int resync = 0; resync < 2; resync++) {
+    size_t ready = parse_bytes(data, size, resync, false);
+    if (parse_bytes(data, size, resync, true) != ready) {
+      __builtin_trap();
+    }
+    if (parse_buffer(data, size, resync) != ready) {
+      __builtin_trap();
+    }
+  }
+  return 0;
+}
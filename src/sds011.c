@@ -5,24 +5,28 @@
 
 static bool init_req_queue(sds011_t *self);
 
+
 sds011_err_t sds011_init(sds011_t *self, sds011_init_t const *init) {
   if (self == NULL) { return SDS011_ERR_INVALID_PARAM; }
   if (init == NULL) { return SDS011_ERR_INVALID_PARAM; }
   if (init->millis == NULL) { return SDS011_ERR_INVALID_PARAM; }
-  if (init->serial.bytes_available == NULL) {
+  if (init->serial.bytes_available == NULL && init->serial.read == NULL) {
     return SDS011_ERR_INVALID_PARAM;
   }
-  if (init->serial.read_byte == NULL) {
+  if (init->serial.read_byte == NULL && init->serial.read == NULL) {
     return SDS011_ERR_INVALID_PARAM;
   }
-  if (init->serial.send_byte == NULL) {
+  if (init->serial.send_byte == NULL && init->serial.write == NULL && init->tx_ring == NULL) {
     return SDS011_ERR_INVALID_PARAM;
   }
 
   self->cfg = *init;
   sds011_parser_init(&self->parser);
+  sds011_parser_set_resync(&self->parser, true);
+  sds011_parser_set_lazy(&self->parser, true);
 
   memset(&self->on_sample, 0, sizeof(self->on_sample));
+  memset(&self->on_sample_value, 0, sizeof(self->on_sample_value));
 
   if (init_req_queue(self) == false) {
     return SDS011_ERR_INVALID_PARAM;
@@ -34,14 +38,24 @@ sds011_err_t sds011_init(sds011_t *self, sds011_init_t const *init) {
 static bool init_req_queue(sds011_t *self) {
   sds011_requests_t *req = &self->req;
 
-  memset(req->mem, 0, sizeof(req->mem));
-  memset(&req->active, 0, sizeof(req->active));
-  req->status = SDS011_REQ_STATUS_IDLE;
-  req->critical = false;
-  req->retry = 0;
-  req->start_time = 0;
-
-  return sds011_fifo_init(&req->queue, sizeof(sds011_request_t), req->mem, sizeof(req->mem));
+  sds011_frame_cache_init(&req->cache);
+  memset(req->inflight, 0, sizeof(req->inflight));
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    req->inflight[i].status = SDS011_REQ_STATUS_IDLE;
+  }
+  req->tx = NULL;
+#if SDS011_REQ_QUEUE_MPSC
+  req->has_popped = false;
+#endif
+
+#if SDS011_REQ_QUEUE_MPSC
+  return sds011_mpsc_fifo_init(&req->queue, sizeof(sds011_request_t), req->mem, sizeof(req->mem)) &&
+         sds011_mpsc_fifo_init(&req->high_queue, sizeof(sds011_request_t), req->high_mem, sizeof(req->high_mem));
+#else
+  sds011_req_ring_init(&req->queue, SDS011_REQ_QUEUE_SIZE);
+  sds011_req_high_ring_init(&req->high_queue, SDS011_REQ_HIGH_QUEUE_SIZE);
+  return true;
+#endif
 }
 
 sds011_err_t sds011_set_sample_callback(sds011_t *self, sds011_on_sample_t cb) {
@@ -50,23 +64,40 @@ sds011_err_t sds011_set_sample_callback(sds011_t *self, sds011_on_sample_t cb) {
   return SDS011_OK;
 }
 
-static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg, sds011_cb_t cb);
+sds011_err_t sds011_set_sample_value_callback(sds011_t *self, sds011_on_sample_value_t cb) {
+  if (self == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  self->on_sample_value = cb;
+  return SDS011_OK;
+}
+
+static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg,
+                             sds011_req_priority_t priority, sds011_cb_t cb);
 
 sds011_err_t sds011_query_data(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_query_data_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_query_data_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id = dev_id,
     .type   = SDS011_MSG_TYPE_DATA,
     .op     = SDS011_MSG_OP_GET,
     .src    = SDS011_MSG_SRC_HOST
-  }, cb);
+  }, priority, cb);
 }
 
 static void confirm(sds011_cb_t *cb, sds011_err_t err, sds011_msg_t const *msg);
 
-static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg, sds011_cb_t cb) {
+#if SDS011_REQ_QUEUE_MPSC
+static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg,
+                             sds011_req_priority_t priority, sds011_cb_t cb) {
   if (self == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  if ((unsigned)priority >= SDS011_REQ_PRIORITY_COUNT) { return SDS011_ERR_INVALID_PARAM; }
+
+  sds011_mpsc_fifo_t *queue = (priority == SDS011_REQ_PRIORITY_HIGH) ?
+    &self->req.high_queue : &self->req.queue;
 
-  if (sds011_fifo_push(&self->req.queue, &(sds011_request_t) {
+  if (sds011_mpsc_fifo_push(queue, &(sds011_request_t) {
     .msg   = *msg,
     .cb    = cb,
   }) == false) {
@@ -76,6 +107,32 @@ static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg, sds011_cb_
 
   return SDS011_OK;
 }
+#else
+// The request is built in its slot.
+static sds011_err_t push_msg(sds011_t *self, sds011_msg_t const *msg,
+                             sds011_req_priority_t priority, sds011_cb_t cb) {
+  if (self == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  if ((unsigned)priority >= SDS011_REQ_PRIORITY_COUNT) { return SDS011_ERR_INVALID_PARAM; }
+
+  bool high = (priority == SDS011_REQ_PRIORITY_HIGH);
+  sds011_request_t *req = high ? sds011_req_high_ring_reserve(&self->req.high_queue) :
+                                 sds011_req_ring_reserve(&self->req.queue);
+  if (req == NULL) {
+    confirm(&cb, SDS011_ERR_BUSY, NULL);
+    return SDS011_ERR_BUSY;
+  }
+
+  req->msg = *msg;
+  req->cb  = cb;
+  if (high == true) {
+    sds011_req_high_ring_commit(&self->req.high_queue);
+  } else {
+    sds011_req_ring_commit(&self->req.queue);
+  }
+
+  return SDS011_OK;
+}
+#endif
 
 static void confirm(sds011_cb_t *cb, sds011_err_t err, sds011_msg_t const *msg) {
   if (cb->callback) {
@@ -84,74 +141,106 @@ static void confirm(sds011_cb_t *cb, sds011_err_t err, sds011_msg_t const *msg)
 }
 
 sds011_err_t sds011_set_device_id(sds011_t *self, uint16_t dev_id, uint16_t new_id, sds011_cb_t cb) {
+  return sds011_set_device_id_prio(self, dev_id, new_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_device_id_prio(sds011_t *self, uint16_t dev_id, uint16_t new_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id          = dev_id,
     .type            = SDS011_MSG_TYPE_DEV_ID,
     .op              = SDS011_MSG_OP_SET,
     .src             = SDS011_MSG_SRC_HOST,
     .data.new_dev_id = new_id,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_rep_mode_active(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_set_rep_mode_active_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_rep_mode_active_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id        = dev_id,
     .type          = SDS011_MSG_TYPE_REP_MODE,
     .op            = SDS011_MSG_OP_SET,
     .src           = SDS011_MSG_SRC_HOST,
     .data.rep_mode = SDS011_REP_MODE_ACTIVE,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_rep_mode_query(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_set_rep_mode_query_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_rep_mode_query_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id        = dev_id,
     .type          = SDS011_MSG_TYPE_REP_MODE,
     .op            = SDS011_MSG_OP_SET,
     .src           = SDS011_MSG_SRC_HOST,
     .data.rep_mode = SDS011_REP_MODE_QUERY,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_get_rep_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_get_rep_mode_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_get_rep_mode_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id = dev_id,
     .type   = SDS011_MSG_TYPE_REP_MODE,
     .op     = SDS011_MSG_OP_GET,
     .src    = SDS011_MSG_SRC_HOST,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_sleep_on(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_set_sleep_on_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_sleep_on_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id     = dev_id,
     .type       = SDS011_MSG_TYPE_SLEEP,
     .op         = SDS011_MSG_OP_SET,
     .src        = SDS011_MSG_SRC_HOST,
     .data.sleep = SDS011_SLEEP_ON,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_sleep_off(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_set_sleep_off_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_sleep_off_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id     = dev_id,
     .type       = SDS011_MSG_TYPE_SLEEP,
     .op         = SDS011_MSG_OP_SET,
     .src        = SDS011_MSG_SRC_HOST,
     .data.sleep = SDS011_SLEEP_OFF,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_get_sleep(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_get_sleep_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_get_sleep_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id = dev_id,
     .type   = SDS011_MSG_TYPE_SLEEP,
     .op     = SDS011_MSG_OP_GET,
     .src    = SDS011_MSG_SRC_HOST,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_op_mode_continous(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_set_op_mode_continous_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_op_mode_continous_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id                 = dev_id,
     .type                   = SDS011_MSG_TYPE_OP_MODE,
@@ -159,10 +248,14 @@ sds011_err_t sds011_set_op_mode_continous(sds011_t *self, uint16_t dev_id, sds01
     .src                    = SDS011_MSG_SRC_HOST,
     .data.op_mode.mode      = SDS011_OP_MODE_CONTINOUS,
     .data.op_mode.interval  = 0,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_set_op_mode_periodic(sds011_t *self, uint16_t dev_id, uint8_t ival, sds011_cb_t cb) {
+  return sds011_set_op_mode_periodic_prio(self, dev_id, ival, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_set_op_mode_periodic_prio(sds011_t *self, uint16_t dev_id, uint8_t ival, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id                 = dev_id,
     .type                   = SDS011_MSG_TYPE_OP_MODE,
@@ -170,73 +263,190 @@ sds011_err_t sds011_set_op_mode_periodic(sds011_t *self, uint16_t dev_id, uint8_
     .src                    = SDS011_MSG_SRC_HOST,
     .data.op_mode.mode      = SDS011_OP_MODE_INTERVAL,
     .data.op_mode.interval  = ival,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_get_op_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_get_op_mode_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_get_op_mode_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id = dev_id,
     .type   = SDS011_MSG_TYPE_OP_MODE,
     .op     = SDS011_MSG_OP_GET,
     .src    = SDS011_MSG_SRC_HOST,
-  }, cb);
+  }, priority, cb);
 }
 
 sds011_err_t sds011_get_fw_ver(sds011_t *self, uint16_t dev_id, sds011_cb_t cb) {
+  return sds011_get_fw_ver_prio(self, dev_id, SDS011_REQ_PRIORITY_NORMAL, cb);
+}
+
+sds011_err_t sds011_get_fw_ver_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb) {
   return push_msg(self, &(sds011_msg_t) {
     .dev_id = dev_id,
     .type   = SDS011_MSG_TYPE_FW_VER,
     .op     = SDS011_MSG_OP_GET,
     .src    = SDS011_MSG_SRC_HOST,
-  }, cb);
+  }, priority, cb);
 }
 
 static bool is_timeout(sds011_t const *self, uint32_t beg, uint32_t timeout);
-static void send_active_msg(sds011_t *self);
+static void process_request(sds011_t *self, sds011_inflight_t *req);
+static void start_requests(sds011_t *self);
+static void send_msg(sds011_t *self, sds011_inflight_t *req);
+static void send_pending(sds011_t *self, sds011_inflight_t *req);
+static bool get_frame(sds011_t *self, sds011_inflight_t *req, uint8_t const **frame);
+static void send_ring(sds011_t *self, sds011_tx_ring_t *ring, sds011_inflight_t *req);
+static void send_serial(sds011_t *self, sds011_inflight_t *req);
+static sds011_request_t const *next_request(sds011_requests_t *req, sds011_req_priority_t *priority);
+static void drop_request(sds011_requests_t *req, sds011_req_priority_t priority);
+static bool can_start(sds011_requests_t const *req, sds011_msg_t const *msg);
+static void complete_request(sds011_t *self, sds011_inflight_t *req, sds011_err_t err, sds011_msg_t const *msg);
 static sds011_err_t process_byte(sds011_t *self, uint8_t byte);
+static sds011_err_t process_block(sds011_t *self);
 
 sds011_err_t sds011_process(sds011_t *self) {
   sds011_err_t err_code = SDS011_OK;
 
-  while (self->cfg.serial.bytes_available(self->cfg.serial.user_data) > 0) {
-    uint8_t byte = self->cfg.serial.read_byte(self->cfg.serial.user_data);
-    if ((err_code = process_byte(self, byte)) != SDS011_OK) {
-      break;
+  if (self->cfg.serial.read != NULL) {
+    err_code = process_block(self);
+  } else {
+    while (self->cfg.serial.bytes_available(self->cfg.serial.user_data) > 0) {
+      uint8_t byte = self->cfg.serial.read_byte(self->cfg.serial.user_data);
+      if ((err_code = process_byte(self, byte)) != SDS011_OK) {
+        break;
+      }
     }
   }
 
-  if (self->req.status == SDS011_REQ_STATUS_RUNNING) {
-    if (is_timeout(self, self->req.start_time, self->cfg.msg_timeout)) {
-      self->req.status = SDS011_REQ_STATUS_FAILURE;
-      self->req.err = SDS011_ERR_TIMEOUT;
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    process_request(self, &self->req.inflight[i]);
+  }
+
+  start_requests(self);
+
+  return err_code;
+}
+
+static void process_request(sds011_t *self, sds011_inflight_t *req) {
+  if (req->status == SDS011_REQ_STATUS_RUNNING) {
+    if (req->tx_offset < req->frame_size) {
+      send_pending(self, req); // resume transmission
+    }
+    if (is_timeout(self, req->start_time, self->cfg.msg_timeout)) {
+      req->status = SDS011_REQ_STATUS_FAILURE;
+      req->err = (req->tx_offset < req->frame_size) ?
+        SDS011_ERR_SEND_DATA : SDS011_ERR_TIMEOUT;
     }
   }
 
-  if (self->req.status == SDS011_REQ_STATUS_SUCCESS) {
-    confirm(&self->req.active.cb, SDS011_OK, &self->req.msg);
-    self->req.status = SDS011_REQ_STATUS_IDLE;
+  if (req->status == SDS011_REQ_STATUS_SUCCESS) {
+    complete_request(self, req, SDS011_OK, &req->msg);
   }
 
-  if (self->req.status == SDS011_REQ_STATUS_FAILURE) {
-    if (self->req.critical == true) {
-      confirm(&self->req.active.cb, self->req.err, NULL);
-      self->req.status = SDS011_REQ_STATUS_IDLE;
-    } else if (++self->req.retry >= self->cfg.retries) {
-      confirm(&self->req.active.cb, self->req.err, NULL);
-      self->req.status = SDS011_REQ_STATUS_IDLE;
+  if (req->status == SDS011_REQ_STATUS_FAILURE) {
+    if (req->critical == true) {
+      complete_request(self, req, req->err, NULL);
+    } else if (++req->retry >= self->cfg.retries) {
+      complete_request(self, req, req->err, NULL);
     } else {
-      send_active_msg(self);
+      send_msg(self, req);
     }
   }
+}
 
-  if (self->req.status == SDS011_REQ_STATUS_IDLE) {
-    if (sds011_fifo_pop(&self->req.queue, &self->req.active) == true) {
-      self->req.retry = 0;
-      send_active_msg(self);
+// Requests are started in queue order while in-flight entries are free,
+// a request that cannot run yet holds back the requests behind it.
+static void start_requests(sds011_t *self) {
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    sds011_inflight_t *req = &self->req.inflight[i];
+    if (req->status != SDS011_REQ_STATUS_IDLE) {
+      continue;
     }
+
+    sds011_req_priority_t priority;
+    sds011_request_t const *next = next_request(&self->req, &priority);
+    if (next == NULL || can_start(&self->req, &next->msg) == false) {
+      return;
+    }
+
+    req->request = *next;
+    drop_request(&self->req, priority);
+    req->retry = 0;
+    send_msg(self, req);
   }
+}
 
-  return err_code;
+// The oldest request of the highest non-empty priority level is next.
+// A request popped from the MPSC queue is kept until it is started.
+static sds011_request_t const *next_request(sds011_requests_t *req, sds011_req_priority_t *priority) {
+  *priority = SDS011_REQ_PRIORITY_NORMAL;
+#if SDS011_REQ_QUEUE_MPSC
+  if (req->has_popped == true) {
+    return &req->popped;
+  }
+#endif
+#if SDS011_REQ_QUEUE_MPSC
+  if (sds011_mpsc_fifo_pop(&req->high_queue, &req->popped) == true) {
+    *priority = SDS011_REQ_PRIORITY_HIGH;
+  } else if (sds011_mpsc_fifo_pop(&req->queue, &req->popped) == false) {
+    return NULL;
+  }
+  req->has_popped = true;
+  return &req->popped;
+#else
+  sds011_request_t const *next = sds011_req_high_ring_peek(&req->high_queue);
+  if (next != NULL) {
+    *priority = SDS011_REQ_PRIORITY_HIGH;
+    return next;
+  }
+  return sds011_req_ring_peek(&req->queue);
+#endif
+}
+
+static void drop_request(sds011_requests_t *req, sds011_req_priority_t priority) {
+#if SDS011_REQ_QUEUE_MPSC
+  (void)priority;
+  req->has_popped = false;
+#else
+  if (priority == SDS011_REQ_PRIORITY_HIGH) {
+    sds011_req_high_ring_release(&req->high_queue);
+  } else {
+    sds011_req_ring_release(&req->queue);
+  }
+#endif
+}
+
+// Replies are matched by device id, a broadcast or a device id change
+// cannot be told apart from the replies of the other requests.
+static bool is_exclusive(sds011_msg_t const *msg) {
+  return msg->dev_id == 0xFFFF || msg->type == SDS011_MSG_TYPE_DEV_ID;
+}
+
+static bool can_start(sds011_requests_t const *req, sds011_msg_t const *msg) {
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    sds011_inflight_t const *other = &req->inflight[i];
+    if (other->status == SDS011_REQ_STATUS_IDLE) {
+      continue;
+    }
+    if (is_exclusive(msg) || is_exclusive(&other->request.msg)) {
+      return false;
+    }
+    if (other->request.msg.dev_id == msg->dev_id) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void complete_request(sds011_t *self, sds011_inflight_t *req, sds011_err_t err, sds011_msg_t const *msg) {
+  confirm(&req->request.cb, err, msg);
+  if (self->req.tx == req) {
+    self->req.tx = NULL;
+  }
+  req->status = SDS011_REQ_STATUS_IDLE;
 }
 
 static bool is_timeout(sds011_t const *self, uint32_t beg, uint32_t timeout) {
@@ -246,51 +456,111 @@ static bool is_timeout(sds011_t const *self, uint32_t beg, uint32_t timeout) {
   return (self->cfg.millis() - beg) > timeout;
 }
 
-static bool send_buffer(sds011_t *self, uint8_t const *buf, size_t size);
 
-static void send_active_msg(sds011_t *self) {
-  static uint8_t buffer[SDS011_QUERY_PACKET_SIZE];
+// The frame is copied from the cache on the first attempt, so another
+// in-flight request cannot evict it, retries send the same frame again.
+// With the transmit ring the frame is copied from the cache straight into
+// the ring slot, a retry does not queue it again while the copy queued
+// before is still pending.
+static void send_msg(sds011_t *self, sds011_inflight_t *req) {
+  req->status = SDS011_REQ_STATUS_RUNNING;
+  req->critical = false;
+  req->start_time = self->cfg.millis();
 
-  self->req.status = SDS011_REQ_STATUS_RUNNING;
-  self->req.critical = false;
-  self->req.start_time = self->cfg.millis();
+  if (req->retry == 0) {
+    req->tx_queued = false; // frame of the previous request is not waited for
 
-  size_t bytes;
-  sds011_msg_t *msg = &self->req.active.msg;
+    uint8_t const *frame;
+    if (get_frame(self, req, &frame) == false) {
+      return;
+    }
+    if (self->cfg.tx_ring == NULL) {
+      memcpy(req->frame, frame, req->frame_size);
+    }
+  }
 
-  if ((bytes = sds011_builder_build(msg, buffer, sizeof(buffer))) == 0) {
-    self->req.err      = sds011_builder_get_error();
-    self->req.status   = SDS011_REQ_STATUS_FAILURE;
-    self->req.critical = true;
-    return;
+  req->tx_offset = 0;
+  send_pending(self, req);
+}
+
+// Sends as much of the frame as the serial port accepts without waiting,
+// the rest is sent by the following sds011_process calls. Frames are not
+// interleaved, a request waits until the frame of another one is sent.
+// The reply timeout starts when the whole frame is sent.
+static void send_pending(sds011_t *self, sds011_inflight_t *req) {
+  if (self->cfg.tx_ring != NULL) {
+    send_ring(self, self->cfg.tx_ring, req);
+  } else {
+    if (self->req.tx != NULL && self->req.tx != req) {
+      return;
+    }
+    self->req.tx = req;
+    send_serial(self, req);
+    if (req->tx_offset >= req->frame_size) {
+      self->req.tx = NULL;
+    }
   }
 
-  if (bytes > sizeof(buffer)) {
-    self->req.err      = SDS011_ERR_INVALID_DATA;
-    self->req.status   = SDS011_REQ_STATUS_FAILURE;
-    self->req.critical = true;
-    return;
+  if (req->tx_offset >= req->frame_size) {
+    req->start_time = self->cfg.millis();
   }
+}
 
-  if (send_buffer(self, buffer, bytes) == false) {
-    self->req.err    = SDS011_ERR_SEND_DATA;
-    self->req.status = SDS011_REQ_STATUS_FAILURE;
-    return;
+static bool get_frame(sds011_t *self, sds011_inflight_t *req, uint8_t const **frame) {
+  sds011_err_t err_code = sds011_frame_cache_get(&self->req.cache, &req->request.msg,
+                                                 frame, &req->frame_size);
+  if (err_code != SDS011_OK) {
+    req->frame_size = 0;
+    req->err        = err_code;
+    req->status     = SDS011_REQ_STATUS_FAILURE;
+    req->critical   = true;
+    return false;
+  }
+  return true;
+}
+
+// The frame is sent when the ring has consumed all its bytes, until then
+// the queued copy is not pushed again.
+static void send_ring(sds011_t *self, sds011_tx_ring_t *ring, sds011_inflight_t *req) {
+  if (req->tx_queued == false) {
+    uint8_t *slot = sds011_tx_ring_reserve(ring);
+    uint8_t const *frame;
+    if (slot == NULL || get_frame(self, req, &frame) == false) {
+      return;
+    }
+    memcpy(slot, frame, req->frame_size);
+    sds011_tx_ring_commit(ring, req->frame_size);
+    req->tx_queued = true;
+    req->tx_seq = sds011_tx_ring_last(ring);
+  }
+  if (sds011_tx_ring_is_sent(ring, req->tx_seq) == true) {
+    req->tx_queued = false;
+    req->tx_offset = req->frame_size;
   }
 }
 
-static bool send_buffer(sds011_t *self, uint8_t const *buf, size_t size) {
-  for (size_t i = 0; i < size; i++) {
-    uint8_t byte = buf[i];
-    do {
-      if (is_timeout(self, self->req.start_time, self->cfg.msg_timeout)) {
-        return false;
+static void send_serial(sds011_t *self, sds011_inflight_t *req) {
+  if (self->cfg.serial.write != NULL) {
+    while (req->tx_offset < req->frame_size) {
+      size_t sent = self->cfg.serial.write(&req->frame[req->tx_offset],
+                                           req->frame_size - req->tx_offset,
+                                           self->cfg.serial.user_data);
+      if (sent == 0) {
+        break;
       }
-    } while (self->cfg.serial.send_byte(byte, self->cfg.serial.user_data) == false);
+      req->tx_offset += sent;
+    }
+  } else {
+    while (req->tx_offset < req->frame_size) {
+      if (self->cfg.serial.send_byte(req->frame[req->tx_offset], self->cfg.serial.user_data) == false) {
+        break;
+      }
+      req->tx_offset++;
+    }
   }
-  return true;
 }
 
+static bool on_sample_value(sds011_t *self);
 static void on_message(sds011_t *self, sds011_msg_t const *msg);
 
 static sds011_err_t process_byte(sds011_t *self, uint8_t byte) {
@@ -303,6 +573,9 @@ static sds011_err_t process_byte(sds011_t *self, uint8_t byte) {
     case SDS011_PARSER_RES_ERROR:
       return sds011_parser_get_error(&self->parser);
     case SDS011_PARSER_RES_READY:
+      if (on_sample_value(self) == true) {
+        break;
+      }
       sds011_parser_get_msg(&self->parser, &msg);
       on_message(self, &msg);
       break;
@@ -311,8 +584,98 @@ static sds011_err_t process_byte(sds011_t *self, uint8_t byte) {
   return SDS011_OK;
 }
 
-static bool is_callback_for_msg(sds011_t const *self, sds011_msg_t const *msg);
+static sds011_err_t parser_error_since(sds011_parser_t const *parser,
+                                       sds011_parser_stats_t const *prev);
+static void on_block_message(sds011_t *self, sds011_msg_t const *msg);
+
+// Data is read in blocks until the serial port has no more data. Unlike
+// the byte interface, processing does not stop on an invalid packet, the
+// following packets are still processed and an error found in the blocks
+// is returned.
+static sds011_err_t process_block(sds011_t *self) {
+  uint8_t buf[SDS011_RX_BLOCK_SIZE];
+  sds011_msg_t msgs[SDS011_RX_BLOCK_SIZE / SDS011_REPLY_PACKET_SIZE + 1];
+  sds011_parser_stats_t stats;
+  size_t len;
+
+  sds011_parser_get_stats(&self->parser, &stats);
+
+  do {
+    len = self->cfg.serial.read(buf, sizeof(buf), self->cfg.serial.user_data);
+    if (len > sizeof(buf)) {
+      len = sizeof(buf);
+    }
+
+    for (size_t iter = 0; iter < len; ) {
+      size_t consumed;
+      size_t ready = sds011_parser_parse_buffer(&self->parser, &buf[iter], len - iter,
+                                                msgs, sizeof(msgs) / sizeof(msgs[0]), &consumed);
+      for (size_t i = 0; i < ready; i++) {
+        on_block_message(self, &msgs[i]);
+      }
+      iter += consumed;
+    }
+  } while (len == sizeof(buf));
+
+  return parser_error_since(&self->parser, &stats);
+}
+
+// The parser error is overwritten by the following valid packets, the
+// error is derived from the statistics instead.
+static sds011_err_t parser_error_since(sds011_parser_t const *parser,
+                                       sds011_parser_stats_t const *prev) {
+  sds011_parser_stats_t stats;
+  sds011_parser_get_stats(parser, &stats);
+
+  if (stats.invalid_data != prev->invalid_data) { return SDS011_ERR_INVALID_DATA; }
+  if (stats.invalid_type != prev->invalid_type) { return SDS011_ERR_INVALID_MSG_TYPE; }
+  if (stats.crc_errors   != prev->crc_errors  ) { return SDS011_ERR_PARSER_CRC; }
+  if (stats.cmd_errors   != prev->cmd_errors  ) { return SDS011_ERR_PARSER_CMD; }
+  if (stats.end_errors   != prev->end_errors  ) { return SDS011_ERR_PARSER_FRAME_END; }
+  if (stats.skipped      != prev->skipped     ) { return SDS011_ERR_PARSER_FRAME_BEG; }
+  return SDS011_OK;
+}
+
+static void on_block_message(sds011_t *self, sds011_msg_t const *msg) {
+  if (msg->type == SDS011_MSG_TYPE_DATA && msg->src == SDS011_MSG_SRC_SENSOR) {
+    if (self->on_sample_value.callback) {
+      self->on_sample_value.callback(msg->dev_id, msg->data.sample,
+                                     self->on_sample_value.user_data);
+    }
+  }
+  on_message(self, msg);
+}
+
+// Returns true if the packet was a sensor data reply and nothing else
+// needs the decoded message.
+static bool on_sample_value(sds011_t *self) {
+  uint16_t dev_id;
+  sds011_sample_t sample;
+
+  if (sds011_parser_get_sample(&self->parser, &dev_id, &sample) == false) {
+    return false;
+  }
+
+  if (self->on_sample_value.callback) {
+    self->on_sample_value.callback(dev_id, sample, self->on_sample_value.user_data);
+  }
+
+  if (self->on_sample.callback) {
+    return false;
+  }
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    if (self->req.inflight[i].status == SDS011_REQ_STATUS_RUNNING &&
+        self->req.inflight[i].request.msg.type == SDS011_MSG_TYPE_DATA) {
+      return false;
+    }
+  }
+  return true;
+}
 
+static bool is_callback_for_msg(sds011_inflight_t const *req, sds011_msg_t const *msg);
+
+// The reply completes the first running request it matches, requests to
+// the same device never run at once.
 static void on_message(sds011_t *self, sds011_msg_t const *msg) {
   if (msg->type == SDS011_MSG_TYPE_DATA) {
     if (self->on_sample.callback) {
@@ -320,33 +683,38 @@ static void on_message(sds011_t *self, sds011_msg_t const *msg) {
     }
   }
 
-  if (is_callback_for_msg(self, msg) == false) {
-    return;
-  }
+  for (size_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    sds011_inflight_t *req = &self->req.inflight[i];
 
-  if (sds011_validator_validate(&self->req.active.msg, msg) == false) {
-    self->req.status = SDS011_REQ_STATUS_FAILURE;
-    self->req.err = SDS011_ERR_INVALID_REPLY;
-  } else {
-    self->req.status = SDS011_REQ_STATUS_SUCCESS;
-    self->req.msg = *msg;
+    if (is_callback_for_msg(req, msg) == false) {
+      continue;
+    }
+
+    if (sds011_validator_validate(&req->request.msg, msg) == false) {
+      req->status = SDS011_REQ_STATUS_FAILURE;
+      req->err = SDS011_ERR_INVALID_REPLY;
+    } else {
+      req->status = SDS011_REQ_STATUS_SUCCESS;
+      req->msg = *msg;
+    }
+    return;
   }
 }
 
-static bool is_callback_for_msg(sds011_t const *self, sds011_msg_t const *msg) {
-  if (self->req.status != SDS011_REQ_STATUS_RUNNING) { return false; }
+static bool is_callback_for_msg(sds011_inflight_t const *req, sds011_msg_t const *msg) {
+  if (req->status != SDS011_REQ_STATUS_RUNNING) { return false; }
 
-  if (self->req.active.msg.type != msg->type) { return false; }
-  if (self->req.active.msg.op   != msg->op  ) { return false; }
+  if (req->request.msg.type != msg->type) { return false; }
+  if (req->request.msg.op   != msg->op  ) { return false; }
 
   if (msg->type == SDS011_MSG_TYPE_DEV_ID) {
-    if (self->req.active.msg.data.new_dev_id != msg->dev_id) {
+    if (req->request.msg.data.new_dev_id != msg->dev_id) {
       return false;
     }
   }
 
-  if (self->req.active.msg.dev_id != 0xFFFF) {
-    if (self->req.active.msg.dev_id != msg->dev_id) {
+  if (req->request.msg.dev_id != 0xFFFF) {
+    if (req->request.msg.dev_id != msg->dev_id) {
       return false;
     }
   }
@@ -10,7 +10,12 @@
 #include "sds011_parser.h"
 #include "sds011_builder.h"
 #include "sds011_validator.h"
-#include "sds011_fifo.h"
+#include "sds011_ring.h"
+#if SDS011_REQ_QUEUE_MPSC
+#include "sds011_mpsc_fifo.h"
+#endif
+#include "sds011_frame_cache.h"
+#include "sds011_tx_ring.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,10 +31,29 @@ typedef struct {
     size_t (*bytes_available)(void *user_data);
     uint8_t (*read_byte)(void *user_data);
     bool (*send_byte)(uint8_t, void *user_data);
+    // Optional block interface, used instead of the byte functions when
+    // set. read returns the number of bytes stored in buf, up to max,
+    // 0 if no data is available. write returns the number of bytes
+    // accepted, the rest is written later.
+    size_t (*read)(uint8_t *buf, size_t max, void *user_data);
+    size_t (*write)(uint8_t const *buf, size_t len, void *user_data);
     void *user_data;
   } serial;
+
+  // Optional, frames are queued in the ring instead of being sent with
+  // send_byte. The ring can be shared by several sensor instances and has
+  // to be flushed, e.g. with sds011_tx_ring_writev, after sds011_process.
+  sds011_tx_ring_t *tx_ring;
 } sds011_init_t;
 
+// Requests are sent in order of priority, requests of the same priority
+// in order of arrival. Running requests are not preempted.
+typedef enum {
+  SDS011_REQ_PRIORITY_NORMAL, // up to SDS011_REQ_QUEUE_SIZE queued requests
+  SDS011_REQ_PRIORITY_HIGH,   // up to SDS011_REQ_HIGH_QUEUE_SIZE queued requests
+  SDS011_REQ_PRIORITY_COUNT,
+} sds011_req_priority_t;
+
 typedef struct {
   void (*callback)(sds011_err_t, sds011_msg_t const *, void *);
   void *user_data;
@@ -40,11 +64,26 @@ typedef struct {
   void *user_data;
 } sds011_on_sample_t;
 
+typedef struct {
+  void (*callback)(uint16_t, sds011_sample_t, void *);
+  void *user_data;
+} sds011_on_sample_value_t;
+
 typedef struct {
   sds011_msg_t msg;
   sds011_cb_t cb;
 } sds011_request_t;
 
+#if SDS011_REQ_QUEUE_MPSC
+static_assert(SDS011_REQ_QUEUE_SIZE >= 2 && SDS011_REQ_HIGH_QUEUE_SIZE >= 2,
+              "MPSC request queues need at least 2 cells");
+#endif
+
+#if !SDS011_REQ_QUEUE_MPSC
+SDS011_RING_DECLARE(sds011_req_ring, sds011_request_t, SDS011_RING_POW2(SDS011_REQ_QUEUE_SIZE));
+SDS011_RING_DECLARE(sds011_req_high_ring, sds011_request_t, SDS011_RING_POW2(SDS011_REQ_HIGH_QUEUE_SIZE));
+#endif
+
 typedef enum {
   SDS011_REQ_STATUS_IDLE,
   SDS011_REQ_STATUS_RUNNING,
@@ -52,23 +91,61 @@ typedef enum {
   SDS011_REQ_STATUS_FAILURE,
 } sds011_req_status_t;
 
+/**
+ * Request taken from the queue, running until the reply is received or
+ * the retries are exhausted. Each request has its own copy of the frame,
+ * timeout and retry count.
+ */
 typedef struct {
-  sds011_request_t mem[SDS011_REQ_QUEUE_SIZE+1];
-  sds011_fifo_t queue;
+  sds011_request_t request;
+  uint8_t frame[SDS011_QUERY_PACKET_SIZE]; // not used with the transmit ring
+  size_t frame_size;
+  size_t tx_offset; // bytes of the frame sent so far
+  bool tx_queued;   // frame queued in the transmit ring, not sent yet
+  uint32_t tx_seq;  // number of the queued frame
 
-  sds011_request_t active;
   sds011_req_status_t status;
   bool critical;
   uint32_t retry;
   uint32_t start_time;
   sds011_msg_t msg;
   sds011_err_t err;
+} sds011_inflight_t;
+
+typedef struct {
+  // Queue per priority level, queue for normal and high_queue for high
+  // priority requests
+#if SDS011_REQ_QUEUE_MPSC
+  alignas(SDS011_MPSC_FIFO_ALIGN)
+  uint8_t mem[SDS011_MPSC_FIFO_MEM_SIZE(sizeof(sds011_request_t), SDS011_REQ_QUEUE_SIZE)];
+  alignas(SDS011_MPSC_FIFO_ALIGN)
+  uint8_t high_mem[SDS011_MPSC_FIFO_MEM_SIZE(sizeof(sds011_request_t), SDS011_REQ_HIGH_QUEUE_SIZE)];
+  sds011_mpsc_fifo_t queue;
+  sds011_mpsc_fifo_t high_queue;
+  sds011_request_t popped; // popped request waiting for a free in-flight entry
+  bool has_popped;
+#else
+  // Requests are built in their slots, the slot is released when the
+  // request is started.
+  sds011_req_ring_t queue;
+  sds011_req_high_ring_t high_queue;
+#endif
+  sds011_frame_cache_t cache;
+
+  // Up to SDS011_REQ_INFLIGHT requests to different devices run at once,
+  // requests to the same device, broadcasts and device id changes run
+  // one at a time. Frames are sent one after another, tx is the request
+  // whose frame is being sent, NULL if none. Not used with the transmit
+  // ring, the ring keeps whole frames in order.
+  sds011_inflight_t inflight[SDS011_REQ_INFLIGHT];
+  sds011_inflight_t *tx;
 } sds011_requests_t;
 
 typedef struct {
   sds011_init_t cfg;
   sds011_parser_t parser;
   sds011_on_sample_t on_sample;
+  sds011_on_sample_value_t on_sample_value;
   sds011_requests_t req;
 } sds011_t;
 
@@ -87,6 +164,25 @@ sds011_err_t sds011_init(sds011_t *self, sds011_init_t const *init);
  */
 sds011_err_t sds011_set_sample_callback(sds011_t *self, sds011_on_sample_t cb);
 
+/**
+ * Set on sample value callback, the callback is called with device id and
+ * sample when new sample is received. Unlike the on sample callback, the
+ * message is not decoded, which is cheaper in active reporting mode.
+ * @param self pointer to the sensor instance
+ * @param cb on sample value callback structure
+ */
+sds011_err_t sds011_set_sample_value_callback(sds011_t *self, sds011_on_sample_value_t cb);
+
+/*
+ * Requests are queued and sent by sds011_process. By default requests
+ * have to be issued from the thread calling sds011_process. With
+ * SDS011_REQ_QUEUE_MPSC set to 1 the request functions may be called from
+ * any thread, concurrently with each other and with sds011_process.
+ * Requests are queued with SDS011_REQ_PRIORITY_NORMAL, the _prio variants
+ * take the priority, SDS011_ERR_INVALID_PARAM is returned for an unknown
+ * one.
+ */
+
 /**
  * Query dust sensor data
  * @param self pointer to the sensor instance
@@ -96,6 +192,16 @@ sds011_err_t sds011_set_sample_callback(sds011_t *self, sds011_on_sample_t cb);
  */
 sds011_err_t sds011_query_data(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Query dust sensor data, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_query_data_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Set dust sensor device id
  * @param self pointer to the sensor instance
@@ -106,6 +212,17 @@ sds011_err_t sds011_query_data(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
  */
 sds011_err_t sds011_set_device_id(sds011_t *self, uint16_t dev_id, uint16_t new_id, sds011_cb_t cb);
 
+/**
+ * Set dust sensor device id, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param new_id new sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_device_id_prio(sds011_t *self, uint16_t dev_id, uint16_t new_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Set automatic (active) reporting mode
  * @param self pointer to the sensor instance
@@ -115,6 +232,16 @@ sds011_err_t sds011_set_device_id(sds011_t *self, uint16_t dev_id, uint16_t new_
  */
 sds011_err_t sds011_set_rep_mode_active(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Set automatic (active) reporting mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_rep_mode_active_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Set manual (query) reporting mode
  * @param self pointer to the sensor instance
@@ -124,6 +251,16 @@ sds011_err_t sds011_set_rep_mode_active(sds011_t *self, uint16_t dev_id, sds011_
  */
 sds011_err_t sds011_set_rep_mode_query(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Set manual (query) reporting mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_rep_mode_query_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Get reporting mode. The reporting mode can be retrieved from the callback message parameter.
  * @param self pointer to the sensor instance
@@ -133,6 +270,16 @@ sds011_err_t sds011_set_rep_mode_query(sds011_t *self, uint16_t dev_id, sds011_c
  */
 sds011_err_t sds011_get_rep_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Get reporting mode, queued with the given priority. The reporting mode can be retrieved from the callback message parameter.
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_get_rep_mode_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Turn on the sleep mode
  * @param self pointer to the sensor instance
@@ -142,6 +289,16 @@ sds011_err_t sds011_get_rep_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb
  */
 sds011_err_t sds011_set_sleep_on(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Turn on the sleep mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_sleep_on_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Turn off the sleep mode
  * @param self pointer to the sensor instance
@@ -151,6 +308,16 @@ sds011_err_t sds011_set_sleep_on(sds011_t *self, uint16_t dev_id, sds011_cb_t cb
  */
 sds011_err_t sds011_set_sleep_off(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Turn off the sleep mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_sleep_off_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Get current sleep state. The sleep state can be retrieved from the callback message parameter.
  * @param self pointer to the sensor instance
@@ -160,6 +327,16 @@ sds011_err_t sds011_set_sleep_off(sds011_t *self, uint16_t dev_id, sds011_cb_t c
  */
 sds011_err_t sds011_get_sleep(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Get current sleep state, queued with the given priority. The sleep state can be retrieved from the callback message parameter.
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_get_sleep_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Set continous operation mode
  * @param self pointer to the sensor instance
@@ -169,6 +346,16 @@ sds011_err_t sds011_get_sleep(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
  */
 sds011_err_t sds011_set_op_mode_continous(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Set continous operation mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_op_mode_continous_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Set periodic operation mode
  * @param self pointer to the sensor instance
@@ -179,6 +366,17 @@ sds011_err_t sds011_set_op_mode_continous(sds011_t *self, uint16_t dev_id, sds01
  */
 sds011_err_t sds011_set_op_mode_periodic(sds011_t *self, uint16_t dev_id, uint8_t ival, sds011_cb_t cb);
 
+/**
+ * Set periodic operation mode, queued with the given priority
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param ival sample interval in minutes, value should be between 1 and 30
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_set_op_mode_periodic_prio(sds011_t *self, uint16_t dev_id, uint8_t ival, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Get current operation mode. The operation mode can be retrieved from the callback message parameter.
  * @param self pointer to the sensor instance
@@ -188,6 +386,16 @@ sds011_err_t sds011_set_op_mode_periodic(sds011_t *self, uint16_t dev_id, uint8_
  */
 sds011_err_t sds011_get_op_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Get current operation mode, queued with the given priority. The operation mode can be retrieved from the callback message parameter.
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_get_op_mode_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Get firmware version. The firmware version can be retrieved from the callback message parameter.
  * @param self pointer to the sensor instance
@@ -197,6 +405,16 @@ sds011_err_t sds011_get_op_mode(sds011_t *self, uint16_t dev_id, sds011_cb_t cb)
  */
 sds011_err_t sds011_get_fw_ver(sds011_t *self, uint16_t dev_id, sds011_cb_t cb);
 
+/**
+ * Get firmware version, queued with the given priority. The firmware version can be retrieved from the callback message parameter.
+ * @param self pointer to the sensor instance
+ * @param dev_id sensor id
+ * @param priority request priority
+ * @param cb callback executed on sensor response or when error occurs
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_get_fw_ver_prio(sds011_t *self, uint16_t dev_id, sds011_req_priority_t priority, sds011_cb_t cb);
+
 /**
  * Processing function. This function should be called periodically,
  * in the main loop.
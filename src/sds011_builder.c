@@ -43,33 +43,138 @@ static size_t (*_builder_host[2][(int)SDS011_MSG_TYPE_COUNT])(sds011_msg_t const
 };
 
 size_t sds011_builder_build(sds011_msg_t const *msg, uint8_t *buf, size_t size) {
-  if (msg == NULL || buf == NULL) {
-    _error = SDS011_ERR_INVALID_PARAM;
+  sds011_err_t err_code;
+  size_t bytes = sds011_builder_build_r(msg, buf, size, &err_code);
+
+  if (bytes == 0) {
+    _error = err_code;
+  }
+  return bytes;
+}
+
+static sds011_err_t check_msg(sds011_msg_t const *msg, uint8_t const *buf, size_t size);
+
+size_t sds011_builder_build_r(sds011_msg_t const *msg, uint8_t *buf, size_t size, sds011_err_t *err) {
+  sds011_err_t err_code = check_msg(msg, buf, size);
+
+  if (err != NULL) {
+    *err = err_code;
+  }
+  if (err_code != SDS011_OK) {
     return 0;
   }
+
+  memset(buf, 0, size);
+  return _builder_host[msg->src][msg->type](msg, buf);
+}
+
+static sds011_err_t check_msg(sds011_msg_t const *msg, uint8_t const *buf, size_t size) {
+  if (msg == NULL || buf == NULL) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
   if (msg->src == SDS011_MSG_SRC_HOST && size < SDS011_QUERY_PACKET_SIZE) {
-    _error = SDS011_ERR_MEM;
-    return 0;
+    return SDS011_ERR_MEM;
   }
   if (msg->src == SDS011_MSG_SRC_SENSOR && size < SDS011_REPLY_PACKET_SIZE) {
-    _error = SDS011_ERR_MEM;
-    return 0;
+    return SDS011_ERR_MEM;
   }
   if (msg->src != SDS011_MSG_SRC_HOST && msg->src != SDS011_MSG_SRC_SENSOR) {
-    _error = SDS011_ERR_INVALID_SRC;
-    return 0;
+    return SDS011_ERR_INVALID_SRC;
   }
   if (msg->type >= SDS011_MSG_TYPE_COUNT) {
-    _error = SDS011_ERR_INVALID_MSG_TYPE;
-    return 0;
+    return SDS011_ERR_INVALID_MSG_TYPE;
   }
   if (_builder_host[msg->src][msg->type] == NULL) {
-    _error = SDS011_ERR_INVALID_MSG_TYPE;
+    return SDS011_ERR_INVALID_MSG_TYPE;
+  }
+  return SDS011_OK;
+}
+
+size_t sds011_builder_build_many(sds011_msg_t const *msgs, size_t n, uint8_t *buf, size_t size,
+                                 sds011_builder_frame_t *frames) {
+  size_t offset = 0;
+
+  if (msgs == NULL || buf == NULL || frames == NULL) {
     return 0;
   }
 
-  memset(buf, 0, size);
-  return _builder_host[msg->src][msg->type](msg, buf);
+  for (size_t i = 0; i < n; i++) {
+    // limit the size, sds011_builder_build_r clears the whole buffer
+    size_t space = size - offset;
+    if (space > SDS011_QUERY_PACKET_SIZE) {
+      space = SDS011_QUERY_PACKET_SIZE;
+    }
+
+    size_t bytes = sds011_builder_build_r(&msgs[i], &buf[offset], space, &frames[i].error);
+
+    frames[i].offset = offset;
+    frames[i].size   = bytes;
+
+    offset += bytes;
+  }
+  return offset;
+}
+
+static sds011_err_t build_fleet(sds011_msg_t const *msg, uint16_t const *dev_ids, size_t n,
+                                uint8_t *buf, size_t size, size_t *bytes);
+
+size_t sds011_builder_build_fleet(sds011_msg_t const *msg, uint16_t const *dev_ids, size_t n,
+                                  uint8_t *buf, size_t size, sds011_err_t *err) {
+  size_t bytes = 0;
+  sds011_err_t err_code = build_fleet(msg, dev_ids, n, buf, size, &bytes);
+
+  if (err != NULL) {
+    *err = err_code;
+  }
+  return bytes;
+}
+
+// The device id is the last payload field of every packet, followed by
+// the checksum. Every frame is a copy of the template with three bytes
+// patched. The frame size is a constant in every call, so the copy is
+// done with wide loads and stores instead of a memcpy call.
+static inline void patch_frames(uint16_t const *dev_ids, size_t n, uint8_t *buf,
+                                uint8_t const *frame, size_t frame_size) {
+  size_t dev_id_pos = frame_size - 4;
+  uint8_t crc = (uint8_t)(frame[frame_size - 2] - frame[dev_id_pos] - frame[dev_id_pos + 1]);
+
+  for (size_t i = 0; i < n; i++) {
+    uint8_t *dst = &buf[i * frame_size];
+    uint8_t msb = MSB(dev_ids[i]);
+    uint8_t lsb = LSB(dev_ids[i]);
+
+    memcpy(dst, frame, frame_size);
+    dst[dev_id_pos]     = msb;
+    dst[dev_id_pos + 1] = lsb;
+    dst[frame_size - 2] = (uint8_t)(crc + msb + lsb);
+  }
+}
+
+static sds011_err_t build_fleet(sds011_msg_t const *msg, uint16_t const *dev_ids, size_t n,
+                                uint8_t *buf, size_t size, size_t *bytes) {
+  uint8_t frame[SDS011_QUERY_PACKET_SIZE];
+  sds011_err_t err_code;
+
+  if (dev_ids == NULL || buf == NULL) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+
+  size_t frame_size = sds011_builder_build_r(msg, frame, sizeof(frame), &err_code);
+  if (frame_size == 0) {
+    return err_code;
+  }
+  if (n > size / frame_size) {
+    return SDS011_ERR_MEM;
+  }
+
+  if (frame_size == SDS011_QUERY_PACKET_SIZE) {
+    patch_frames(dev_ids, n, buf, frame, SDS011_QUERY_PACKET_SIZE);
+  } else {
+    patch_frames(dev_ids, n, buf, frame, SDS011_REPLY_PACKET_SIZE);
+  }
+
+  *bytes = n * frame_size;
+  return SDS011_OK;
 }
 
 static size_t build_sens_rep_mode(sds011_msg_t const *msg, uint8_t *buf) {
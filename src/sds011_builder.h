@@ -11,6 +11,15 @@
 extern "C" {
 #endif
 
+/**
+ * Position of a message serialized by sds011_builder_build_many
+ */
+typedef struct {
+  size_t offset;
+  size_t size;
+  sds011_err_t error;
+} sds011_builder_frame_t;
+
 /**
  * Serialize message
  * @parma msg Message to be serialized
@@ -21,7 +30,54 @@ extern "C" {
 size_t sds011_builder_build(sds011_msg_t const *msg, uint8_t *buf, size_t size);
 
 /**
- * Get latest builder error code
+ * @brief Serialize message, reentrant version of sds011_builder_build.
+ *        The error is returned to the caller only, the error returned by
+ *        sds011_builder_get_error is not updated.
+ * @param msg message to be serialized
+ * @param buf buffer for the serialized message
+ * @param size size of the buffer
+ * @param err SDS011_OK on success, otherwise error code, can be NULL
+ * @return output size, 0 in case of an error
+ */
+size_t sds011_builder_build_r(sds011_msg_t const *msg, uint8_t *buf, size_t size, sds011_err_t *err);
+
+/**
+ * @brief Serialize many messages into one buffer.
+ *        Messages are written back to back, the offset, size and error of
+ *        every message are stored in the frames array. A message which
+ *        cannot be serialized, or does not fit in the remaining space, has
+ *        size 0 and the error set, the following messages are still
+ *        serialized. The function is reentrant.
+ * @param msgs messages to be serialized
+ * @param n number of messages
+ * @param buf buffer for the serialized messages
+ * @param size size of the buffer
+ * @param frames position and error of every message, n elements
+ * @return output size
+ */
+size_t sds011_builder_build_many(sds011_msg_t const *msgs, size_t n, uint8_t *buf, size_t size,
+                                 sds011_builder_frame_t *frames);
+
+/**
+ * @brief Serialize the same message for many devices.
+ *        The message is serialized once, the frame of every device is a
+ *        copy with the device id bytes replaced and the checksum corrected
+ *        by the difference. Frames are written back to back in the order
+ *        of the dev_ids array. The dev_id field of the message is ignored.
+ *        The function is reentrant.
+ * @param msg message to be serialized
+ * @param dev_ids device ids
+ * @param n number of device ids
+ * @param buf buffer for the serialized messages, n frames long
+ * @param size size of the buffer
+ * @param err SDS011_OK on success, otherwise error code, can be NULL
+ * @return output size, 0 in case of an error
+ */
+size_t sds011_builder_build_fleet(sds011_msg_t const *msg, uint16_t const *dev_ids, size_t n,
+                                  uint8_t *buf, size_t size, sds011_err_t *err);
+
+/**
+ * Get latest error code of sds011_builder_build, not thread safe
  * @return latest error code
  */
 sds011_err_t sds011_builder_get_error(void);
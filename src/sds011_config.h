@@ -2,5 +2,21 @@
 #define SDS011_CONFIG_H__
 
 #define SDS011_REQ_QUEUE_SIZE 10
+#define SDS011_REQ_HIGH_QUEUE_SIZE 4
+#define SDS011_PARSER_POOL_SIZE 256
+#define SDS011_FRAME_CACHE_SIZE 16
+#define SDS011_TX_RING_SIZE 8
+#define SDS011_RX_BLOCK_SIZE 64
+#define SDS011_CACHE_LINE_SIZE 64
+
+// Requests to different devices sent without waiting for the replies
+#ifndef SDS011_REQ_INFLIGHT
+#define SDS011_REQ_INFLIGHT 1
+#endif
+
+// Set to 1 to allow requests from any thread, see sds011_mpsc_fifo_t
+#ifndef SDS011_REQ_QUEUE_MPSC
+#define SDS011_REQ_QUEUE_MPSC 0
+#endif
 
 #endif // SDS011_CONFIG_H__
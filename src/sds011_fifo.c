@@ -57,3 +57,45 @@ bool sds011_fifo_pop(sds011_fifo_t *fifo, void *el) {
 
   return true;
 }
+
+void* sds011_fifo_reserve(sds011_fifo_t *fifo) {
+  if (fifo == NULL) { return NULL; }
+
+  if (is_full(fifo)) {
+    return NULL;
+  }
+
+  return memloc(fifo, fifo->end);
+}
+
+bool sds011_fifo_commit(sds011_fifo_t *fifo) {
+  if (fifo == NULL) { return false; }
+
+  if (is_full(fifo)) {
+    return false;
+  }
+
+  fifo->end = increase(fifo, fifo->end);
+  return true;
+}
+
+void* sds011_fifo_peek(sds011_fifo_t const *fifo) {
+  if (fifo == NULL) { return NULL; }
+
+  if (is_empty(fifo)) {
+    return NULL;
+  }
+
+  return memloc(fifo, fifo->beg);
+}
+
+bool sds011_fifo_release(sds011_fifo_t *fifo) {
+  if (fifo == NULL) { return false; }
+
+  if (is_empty(fifo)) {
+    return false;
+  }
+
+  fifo->beg = increase(fifo, fifo->beg);
+  return true;
+}
@@ -22,6 +22,36 @@ bool sds011_fifo_init(sds011_fifo_t *fifo, size_t elsize, void *mem, size_t size
 bool sds011_fifo_push(sds011_fifo_t *fifo, void const *el);
 bool sds011_fifo_pop(sds011_fifo_t *fifo, void *el);
 
+/**
+ * Reserve slot for the next element, the element is built in place and
+ * added with sds011_fifo_commit.
+ * @param[in] fifo fifo structure
+ * @return slot, NULL if the fifo is full
+ */
+void* sds011_fifo_reserve(sds011_fifo_t *fifo);
+
+/**
+ * Add element built in the slot returned by sds011_fifo_reserve
+ * @param[in] fifo fifo structure
+ * @return true on success, false if the fifo is full
+ */
+bool sds011_fifo_commit(sds011_fifo_t *fifo);
+
+/**
+ * Get the oldest element without removing it from the fifo, the element
+ * stays valid until sds011_fifo_release.
+ * @param[in] fifo fifo structure
+ * @return element, NULL if the fifo is empty
+ */
+void* sds011_fifo_peek(sds011_fifo_t const *fifo);
+
+/**
+ * Remove the oldest element
+ * @param[in] fifo fifo structure
+ * @return true on success, false if the fifo is empty
+ */
+bool sds011_fifo_release(sds011_fifo_t *fifo);
+
 #ifdef __cplusplus
 }
 #endif
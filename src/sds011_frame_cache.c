@@ -0,0 +1,105 @@
+#include "sds011_frame_cache.h"
+#include "sds011_builder.h"
+
+#include <string.h>
+
+void sds011_frame_cache_init(sds011_frame_cache_t *cache) {
+  memset(cache, 0, sizeof(sds011_frame_cache_t));
+}
+
+static bool make_key(sds011_msg_t const *msg, uint64_t *key);
+static sds011_err_t build_entry(sds011_frame_cache_entry_t *entry, sds011_msg_t const *msg, uint64_t key);
+
+sds011_err_t sds011_frame_cache_get(sds011_frame_cache_t *cache, sds011_msg_t const *msg,
+                                    uint8_t const **frame, size_t *size) {
+  if (cache == NULL || msg == NULL || frame == NULL || size == NULL) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+
+  uint64_t key;
+  sds011_frame_cache_entry_t *entry;
+  sds011_err_t err_code;
+
+  if (make_key(msg, &key) == false) {
+    // not cached, built the same way as without the cache
+    entry = &cache->uncached;
+    if ((err_code = build_entry(entry, msg, 0)) != SDS011_OK) {
+      return err_code;
+    }
+  } else {
+    size_t index = (size_t)((key * 0x9E3779B97F4A7C15u) >> 32) % SDS011_FRAME_CACHE_SIZE;
+    entry = &cache->entries[index];
+
+    if (entry->size == 0 || entry->key != key) {
+      if ((err_code = build_entry(entry, msg, key)) != SDS011_OK) {
+        return err_code;
+      }
+    }
+  }
+
+  *frame = entry->frame;
+  *size = entry->size;
+  return SDS011_OK;
+}
+
+static sds011_err_t build_entry(sds011_frame_cache_entry_t *entry, sds011_msg_t const *msg, uint64_t key) {
+  sds011_err_t err_code;
+  size_t bytes = sds011_builder_build_r(msg, entry->frame, sizeof(entry->frame), &err_code);
+  if (bytes == 0) {
+    entry->size = 0;
+    return err_code;
+  }
+  entry->key = key;
+  entry->size = (uint8_t)bytes;
+  return SDS011_OK;
+}
+
+// Key holds every message field used by the builder:
+// type (8 bits), op (1), src (1), dev_id (16) and payload (32).
+// Returns false if a field does not fit in the key.
+static bool make_key(sds011_msg_t const *msg, uint64_t *key) {
+  uint32_t payload = 0;
+
+  if (msg->src != SDS011_MSG_SRC_HOST && msg->src != SDS011_MSG_SRC_SENSOR) {
+    return false;
+  }
+  if (msg->type >= SDS011_MSG_TYPE_COUNT) {
+    return false;
+  }
+  if (msg->op != SDS011_MSG_OP_GET && msg->op != SDS011_MSG_OP_SET) {
+    return false;
+  }
+
+  switch (msg->type) {
+    case SDS011_MSG_TYPE_REP_MODE:
+      payload = (uint32_t)msg->data.rep_mode & 0xFF;
+      break;
+    case SDS011_MSG_TYPE_DATA:
+      payload = ((uint32_t)msg->data.sample.pm10 << 16) | msg->data.sample.pm2_5;
+      break;
+    case SDS011_MSG_TYPE_DEV_ID:
+      payload = msg->data.new_dev_id;
+      break;
+    case SDS011_MSG_TYPE_SLEEP:
+      payload = (uint32_t)msg->data.sleep & 0xFF;
+      break;
+    case SDS011_MSG_TYPE_FW_VER:
+      payload = ((uint32_t)msg->data.fw_ver.year << 16) |
+                ((uint32_t)msg->data.fw_ver.month << 8) | msg->data.fw_ver.day;
+      break;
+    case SDS011_MSG_TYPE_OP_MODE:
+      if (msg->data.op_mode.mode != SDS011_OP_MODE_CONTINOUS) {
+        payload = msg->data.op_mode.interval;
+      }
+      break;
+    default:
+      break;
+  }
+
+  *key = (uint64_t)msg->type |
+         ((uint64_t)msg->op << 8) |
+         ((uint64_t)msg->src << 9) |
+         ((uint64_t)msg->dev_id << 16) |
+         ((uint64_t)payload << 32);
+  return true;
+}
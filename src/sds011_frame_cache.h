@@ -0,0 +1,57 @@
+#ifndef SDS011_FRAME_CACHE_H__
+#define SDS011_FRAME_CACHE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sds011_config.h"
+#include "sds011_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint64_t key;
+  uint8_t size;
+  uint8_t frame[SDS011_QUERY_PACKET_SIZE];
+} sds011_frame_cache_entry_t;
+
+/**
+ * Serialized frames of SDS011_FRAME_CACHE_SIZE recently sent messages.
+ * Messages are mapped to the entries by type, operation, source, device id
+ * and payload, a new message replaces the entry it is mapped to. Messages
+ * with fields the key cannot hold, e.g. an unknown operation, are built
+ * in a separate entry which is not looked up.
+ */
+typedef struct {
+  sds011_frame_cache_entry_t entries[SDS011_FRAME_CACHE_SIZE];
+  sds011_frame_cache_entry_t uncached;
+} sds011_frame_cache_t;
+
+/**
+ * Initialize frame cache
+ * @param[in] cache frame cache structure
+ */
+void sds011_frame_cache_init(sds011_frame_cache_t *cache);
+
+/**
+ * @brief Get serialized message.
+ *        The message is serialized with sds011_builder_build_r only if it is
+ *        not found in the cache. The frame stays valid until another
+ *        message is mapped to the same cache entry. Errors are the same
+ *        as the ones returned by the builder.
+ * @param[in]  cache frame cache structure
+ * @param[in]  msg message to be serialized
+ * @param[out] frame serialized message
+ * @param[out] size size of the serialized message
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_frame_cache_get(sds011_frame_cache_t *cache, sds011_msg_t const *msg,
+                                    uint8_t const **frame, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_FRAME_CACHE_H__
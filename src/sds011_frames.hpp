@@ -0,0 +1,159 @@
+#ifndef SDS011_FRAMES_HPP__
+#define SDS011_FRAMES_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "sds011_common.h"
+
+/**
+ * Compile time frames of host commands (C++17).
+ * The frames are identical to the ones serialized by sds011_builder_build,
+ * declared as constexpr they are placed in read-only memory:
+ *
+ *   static constexpr auto query = sds011::frames::query_data(0xA160);
+ *   uart_write(query.data(), query.size());
+ */
+namespace sds011 {
+namespace frames {
+
+using frame_t = std::array<uint8_t, SDS011_QUERY_PACKET_SIZE>;
+
+namespace detail {
+
+constexpr frame_t query(uint8_t type, uint8_t op, uint8_t value,
+                        uint16_t new_dev_id, uint16_t dev_id) {
+  frame_t frame{};
+
+  frame[0]  = SDS011_FRAME_BEG;
+  frame[1]  = SDS011_CMD_QUERY;
+  frame[2]  = type;
+  frame[3]  = op;
+  frame[4]  = value;
+  frame[13] = static_cast<uint8_t>(new_dev_id >> 8);
+  frame[14] = static_cast<uint8_t>(new_dev_id & 0xFF);
+  frame[15] = static_cast<uint8_t>(dev_id >> 8);
+  frame[16] = static_cast<uint8_t>(dev_id & 0xFF);
+
+  uint8_t crc = 0;
+  for (std::size_t i = 2; i < SDS011_QUERY_PACKET_SIZE - 2; i++) {
+    crc = static_cast<uint8_t>(crc + frame[i]);
+  }
+  frame[17] = crc;
+  frame[18] = SDS011_FRAME_END;
+  return frame;
+}
+
+constexpr frame_t get(sds011_msg_type_t type, uint16_t dev_id) {
+  return query(type, SDS011_MSG_OP_GET, 0, 0, dev_id);
+}
+
+constexpr frame_t set(sds011_msg_type_t type, uint8_t value, uint16_t dev_id) {
+  return query(type, SDS011_MSG_OP_SET, value, 0, dev_id);
+}
+
+} // namespace detail
+
+/**
+ * Query dust sensor data
+ * @param dev_id sensor id, 0xFFFF for any sensor
+ */
+constexpr frame_t query_data(uint16_t dev_id = 0xFFFF) {
+  return detail::query(SDS011_MSG_TYPE_DATA, 0, 0, 0, dev_id);
+}
+
+/**
+ * Set dust sensor device id
+ * @param dev_id sensor id
+ * @param new_id new sensor id
+ */
+constexpr frame_t set_device_id(uint16_t dev_id, uint16_t new_id) {
+  return detail::query(SDS011_MSG_TYPE_DEV_ID, 0, 0, new_id, dev_id);
+}
+
+/**
+ * Set automatic (active) reporting mode
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_rep_mode_active(uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_REP_MODE, SDS011_REP_MODE_ACTIVE, dev_id);
+}
+
+/**
+ * Set manual (query) reporting mode
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_rep_mode_query(uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_REP_MODE, SDS011_REP_MODE_QUERY, dev_id);
+}
+
+/**
+ * Get reporting mode
+ * @param dev_id sensor id, 0xFFFF for any sensor
+ */
+constexpr frame_t get_rep_mode(uint16_t dev_id = 0xFFFF) {
+  return detail::get(SDS011_MSG_TYPE_REP_MODE, dev_id);
+}
+
+/**
+ * Turn on the sleep mode
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_sleep_on(uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_SLEEP, SDS011_SLEEP_ON, dev_id);
+}
+
+/**
+ * Turn off the sleep mode
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_sleep_off(uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_SLEEP, SDS011_SLEEP_OFF, dev_id);
+}
+
+/**
+ * Get current sleep state
+ * @param dev_id sensor id, 0xFFFF for any sensor
+ */
+constexpr frame_t get_sleep(uint16_t dev_id = 0xFFFF) {
+  return detail::get(SDS011_MSG_TYPE_SLEEP, dev_id);
+}
+
+/**
+ * Set continous operation mode
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_op_mode_continous(uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_OP_MODE, 0, dev_id);
+}
+
+/**
+ * Set periodic operation mode
+ * @param ival sample interval in minutes, value should be between 1 and 30
+ * @param dev_id sensor id, 0xFFFF for all sensors
+ */
+constexpr frame_t set_op_mode_periodic(uint8_t ival, uint16_t dev_id = 0xFFFF) {
+  return detail::set(SDS011_MSG_TYPE_OP_MODE, ival, dev_id);
+}
+
+/**
+ * Get current operation mode
+ * @param dev_id sensor id, 0xFFFF for any sensor
+ */
+constexpr frame_t get_op_mode(uint16_t dev_id = 0xFFFF) {
+  return detail::get(SDS011_MSG_TYPE_OP_MODE, dev_id);
+}
+
+/**
+ * Get firmware version
+ * @param dev_id sensor id, 0xFFFF for any sensor
+ */
+constexpr frame_t get_fw_ver(uint16_t dev_id = 0xFFFF) {
+  return detail::query(SDS011_MSG_TYPE_FW_VER, 0, 0, 0, dev_id);
+}
+
+} // namespace frames
+} // namespace sds011
+
+#endif // SDS011_FRAMES_HPP__
@@ -0,0 +1,85 @@
+#include "sds011_mpsc_fifo.h"
+
+static inline uint8_t* cellloc(sds011_mpsc_fifo_t const *fifo, size_t pos) {
+  return fifo->mem + ((pos % fifo->count) * fifo->cellsize);
+}
+
+static inline atomic_size_t* cell_seq(uint8_t *cell) {
+  return (atomic_size_t *)(void *)cell;
+}
+
+static inline void* cell_el(uint8_t *cell) {
+  return cell + SDS011_MPSC_FIFO_ROUND_UP(sizeof(atomic_size_t));
+}
+
+bool sds011_mpsc_fifo_init(sds011_mpsc_fifo_t *fifo, size_t elsize, void *mem, size_t size) {
+  if (fifo == NULL || mem == NULL) { return false; }
+  if (elsize == 0 || size == 0) { return false; }
+  if ((uintptr_t)mem % SDS011_MPSC_FIFO_ALIGN != 0) { return false; }
+
+  fifo->elsize = elsize;
+  fifo->cellsize = SDS011_MPSC_FIFO_CELL_SIZE(elsize);
+
+  fifo->mem = mem;
+  fifo->size = size;
+  fifo->count = fifo->size / fifo->cellsize;
+
+  // With a single cell its sequence number after a push equals the next
+  // push position, the unread element would be overwritten.
+  if (fifo->count < 2) { return false; }
+
+  for (size_t i = 0; i < fifo->count; i++) {
+    atomic_init(cell_seq(cellloc(fifo, i)), i);
+  }
+
+  atomic_init(&fifo->end, 0);
+  fifo->beg = 0;
+
+  return true;
+}
+
+bool sds011_mpsc_fifo_push(sds011_mpsc_fifo_t *fifo, void const *el) {
+  if (fifo == NULL || el == NULL) { return false; }
+
+  uint8_t *cell;
+  size_t pos = atomic_load_explicit(&fifo->end, memory_order_relaxed);
+
+  for (;;) {
+    cell = cellloc(fifo, pos);
+    size_t seq = atomic_load_explicit(cell_seq(cell), memory_order_acquire);
+
+    if (seq == pos) {
+      // cell free, reserve it
+      if (atomic_compare_exchange_weak_explicit(&fifo->end, &pos, pos + 1,
+          memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if ((intptr_t)(seq - pos) < 0) {
+      return false; // cell not popped yet, fifo full
+    } else {
+      pos = atomic_load_explicit(&fifo->end, memory_order_relaxed);
+    }
+  }
+
+  memcpy(cell_el(cell), el, fifo->elsize);
+  atomic_store_explicit(cell_seq(cell), pos + 1, memory_order_release);
+
+  return true;
+}
+
+bool sds011_mpsc_fifo_pop(sds011_mpsc_fifo_t *fifo, void *el) {
+  if (fifo == NULL || el == NULL) { return false; }
+
+  size_t pos = fifo->beg;
+  uint8_t *cell = cellloc(fifo, pos);
+
+  if (atomic_load_explicit(cell_seq(cell), memory_order_acquire) != pos + 1) {
+    return false;
+  }
+
+  memcpy(el, cell_el(cell), fifo->elsize);
+  atomic_store_explicit(cell_seq(cell), pos + fifo->count, memory_order_release);
+  fifo->beg = pos + 1;
+
+  return true;
+}
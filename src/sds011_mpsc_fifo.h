@@ -0,0 +1,87 @@
+#ifndef SDS011_MPSC_FIFO_H__
+#define SDS011_MPSC_FIFO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "sds011_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Alignment of the fifo memory and of the cells
+ */
+#define SDS011_MPSC_FIFO_ALIGN alignof(max_align_t)
+
+#define SDS011_MPSC_FIFO_ROUND_UP(x) \
+  (((x) + SDS011_MPSC_FIFO_ALIGN - 1) / SDS011_MPSC_FIFO_ALIGN * SDS011_MPSC_FIFO_ALIGN)
+
+/**
+ * Size of a cell, the sequence number followed by the element
+ */
+#define SDS011_MPSC_FIFO_CELL_SIZE(elsize) \
+  SDS011_MPSC_FIFO_ROUND_UP(SDS011_MPSC_FIFO_ROUND_UP(sizeof(atomic_size_t)) + (elsize))
+
+/**
+ * Size of the memory for count elements, all of them can be used
+ */
+#define SDS011_MPSC_FIFO_MEM_SIZE(elsize, count) \
+  (SDS011_MPSC_FIFO_CELL_SIZE(elsize) * (count))
+
+/**
+ * Bounded lock-free multiple producer, single consumer fifo (Vyukov).
+ * Any thread may push, the producers reserve cells with a compare and swap
+ * on the end index and publish them with the per-cell sequence number.
+ * Only one thread may pop.
+ */
+typedef struct {
+  uint8_t *mem;
+  size_t size;
+  size_t elsize;
+  size_t cellsize;
+  size_t count;
+
+  alignas(SDS011_CACHE_LINE_SIZE) atomic_size_t end; // shared by producers
+  alignas(SDS011_CACHE_LINE_SIZE) size_t beg;        // owned by consumer
+} sds011_mpsc_fifo_t;
+
+/**
+ * Initialize fifo, not thread safe.
+ * @param[in] fifo fifo structure
+ * @param[in] elsize size of a single element
+ * @param[in] mem memory for the cells, aligned to SDS011_MPSC_FIFO_ALIGN
+ * @param[in] size size of the memory for at least 2 cells, see
+ *                 SDS011_MPSC_FIFO_MEM_SIZE
+ * @return true on success, otherwise false
+ */
+bool sds011_mpsc_fifo_init(sds011_mpsc_fifo_t *fifo, size_t elsize, void *mem, size_t size);
+
+/**
+ * Push element, may be called by any thread
+ * @param[in] fifo fifo structure
+ * @param[in] el element
+ * @return true on success, false if the fifo is full
+ */
+bool sds011_mpsc_fifo_push(sds011_mpsc_fifo_t *fifo, void const *el);
+
+/**
+ * Pop element, may be called by the consumer only. An element is visible
+ * once its producer completed the push, elements reserved by a producer
+ * which did not complete the push yet block the elements behind them.
+ * @param[in]  fifo fifo structure
+ * @param[out] el element
+ * @return true on success, false if the fifo is empty
+ */
+bool sds011_mpsc_fifo_pop(sds011_mpsc_fifo_t *fifo, void *el);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_MPSC_FIFO_H__
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #define VALUE16(hi, lo) (((uint16_t)(hi) << 8) | (uint16_t)(lo))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
 
 enum {
   STATE_BEG,
@@ -10,12 +11,28 @@ enum {
   STATE_DATA,
   STATE_CRC,
   STATE_END,
+  STATE_COUNT,
 };
 
 static void parser_clear(sds011_parser_t *parser);
 
 void sds011_parser_init(sds011_parser_t *parser) {
   parser_clear(parser);
+  parser->bank      = 0;
+  parser->frame_cmd = 0;
+  parser->frame_tail = 0;
+  parser->resync    = false;
+  parser->lazy      = false;
+  memset(&parser->msg, 0, sizeof(sds011_msg_t));
+  sds011_parser_reset_stats(parser);
+}
+
+void sds011_parser_set_resync(sds011_parser_t *parser, bool enable) {
+  parser->resync = enable;
+}
+
+void sds011_parser_set_lazy(sds011_parser_t *parser, bool enable) {
+  parser->lazy = enable;
 }
 
 static void parser_clear(sds011_parser_t *parser) {
@@ -28,27 +45,109 @@ static void parser_clear(sds011_parser_t *parser) {
 }
 
 static uint8_t parser_data_len_by_cmd(uint8_t cmd);
-static sds011_parser_res_t parser_error(sds011_parser_t *parser, uint32_t err_code);
-static sds011_parser_res_t parser_completed(sds011_parser_t *parser);
+static sds011_parser_res_t parser_error(sds011_parser_t *parser, uint32_t err_code,
+                                        uint8_t byte, sds011_msg_t *msg);
+static sds011_parser_res_t parser_completed(sds011_parser_t *parser, sds011_msg_t *msg);
 
-sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte) {
+#if defined(SDS011_PARSER_TABLE)
+
+// Table driven parser core, the next state is selected by the current
+// state and the class of the received byte. In the CRC state the byte
+// class tells whether the byte matches the calculated CRC.
+enum {
+  CLASS_OTHER,
+  CLASS_BEG,
+  CLASS_CMD,
+  CLASS_END,
+  CLASS_CRC,
+  CLASS_COUNT,
+};
+
+enum {
+  NEXT_ERR_BEG = STATE_COUNT,
+  NEXT_ERR_CMD,
+  NEXT_ERR_CRC,
+  NEXT_ERR_END,
+  NEXT_DONE,
+};
+
+static const uint8_t _byte_class[256] = {
+  [SDS011_FRAME_BEG] = CLASS_BEG,
+  [SDS011_CMD_QUERY] = CLASS_CMD,
+  [SDS011_CMD_REPLY] = CLASS_CMD,
+  [SDS011_DAT_REPLY] = CLASS_CMD,
+  [SDS011_FRAME_END] = CLASS_END,
+};
+
+static const uint8_t _transitions[STATE_COUNT][CLASS_COUNT] = {
+  //                OTHER         BEG           CMD           END           CRC
+  [STATE_BEG]  = { NEXT_ERR_BEG, STATE_CMD,    NEXT_ERR_BEG, NEXT_ERR_BEG, NEXT_ERR_BEG },
+  [STATE_CMD]  = { NEXT_ERR_CMD, NEXT_ERR_CMD, STATE_DATA,   NEXT_ERR_CMD, NEXT_ERR_CMD },
+  [STATE_DATA] = { STATE_DATA,   STATE_DATA,   STATE_DATA,   STATE_DATA,   STATE_DATA   },
+  [STATE_CRC]  = { NEXT_ERR_CRC, NEXT_ERR_CRC, NEXT_ERR_CRC, NEXT_ERR_CRC, STATE_END    },
+  [STATE_END]  = { NEXT_ERR_END, NEXT_ERR_END, NEXT_ERR_END, NEXT_DONE,    NEXT_ERR_END },
+};
+
+static const sds011_err_t _next_errors[] = {
+  [NEXT_ERR_BEG - NEXT_ERR_BEG] = SDS011_ERR_PARSER_FRAME_BEG,
+  [NEXT_ERR_CMD - NEXT_ERR_BEG] = SDS011_ERR_PARSER_CMD,
+  [NEXT_ERR_CRC - NEXT_ERR_BEG] = SDS011_ERR_PARSER_CRC,
+  [NEXT_ERR_END - NEXT_ERR_BEG] = SDS011_ERR_PARSER_FRAME_END,
+};
+
+static inline sds011_parser_res_t parse_byte(sds011_parser_t *parser, uint8_t byte, sds011_msg_t *msg) {
+  uint8_t state = parser->state;
+
+  if (state == STATE_DATA) {
+    parser->data[parser->bank][parser->data_iter++] = byte;
+    parser->data_crc += byte;
+    parser->state += (uint8_t)(parser->data_iter >= parser->data_len);
+    return SDS011_PARSER_RES_RUNNING;
+  }
+  if (state >= STATE_COUNT) {
+    parser_clear(parser);
+    return SDS011_PARSER_RES_RUNNING;
+  }
+
+  uint8_t crc_class = (byte == parser->data_crc) ? CLASS_CRC : CLASS_OTHER;
+  uint8_t cls = (state == STATE_CRC) ? crc_class : _byte_class[byte];
+  uint8_t next = _transitions[state][cls];
+
+  if (next == STATE_DATA) {
+    parser->cmd = byte;
+    parser->data_len = parser_data_len_by_cmd(byte);
+    parser->data_iter = 0;
+  }
+  if (next < STATE_COUNT) {
+    parser->state = next;
+    return SDS011_PARSER_RES_RUNNING;
+  }
+  if (next == NEXT_DONE) {
+    return parser_completed(parser, msg);
+  }
+  return parser_error(parser, _next_errors[next - NEXT_ERR_BEG], byte, msg);
+}
+
+#else
+
+static inline sds011_parser_res_t parse_byte(sds011_parser_t *parser, uint8_t byte, sds011_msg_t *msg) {
   switch (parser->state) {
     case STATE_BEG:
       if (byte != SDS011_FRAME_BEG) {
-        return parser_error(parser, SDS011_ERR_PARSER_FRAME_BEG);
+        return parser_error(parser, SDS011_ERR_PARSER_FRAME_BEG, byte, msg);
       }
       parser->state++;
       break;
     case STATE_CMD:
       if ((parser->data_len = parser_data_len_by_cmd(byte)) == 0) {
-        return parser_error(parser, SDS011_ERR_PARSER_CMD);
+        return parser_error(parser, SDS011_ERR_PARSER_CMD, byte, msg);
       }
       parser->cmd = byte;
       parser->data_iter = 0;
       parser->state++;
       break;
     case STATE_DATA:
-      parser->data[parser->data_iter++] = byte;
+      parser->data[parser->bank][parser->data_iter++] = byte;
       parser->data_crc += byte;
 
       if (parser->data_iter >= parser->data_len) {
@@ -57,15 +156,15 @@ sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte) {
       break;
     case STATE_CRC:
       if (parser->data_crc != byte) {
-        return parser_error(parser, SDS011_ERR_PARSER_CRC);
+        return parser_error(parser, SDS011_ERR_PARSER_CRC, byte, msg);
       }
       parser->state++;
       break;
     case STATE_END:
       if (byte != SDS011_FRAME_END) {
-        return parser_error(parser, SDS011_ERR_PARSER_FRAME_END);
+        return parser_error(parser, SDS011_ERR_PARSER_FRAME_END, byte, msg);
       }
-      return parser_completed(parser);
+      return parser_completed(parser, msg);
     default:
       parser_clear(parser);
       break;
@@ -74,6 +173,65 @@ sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte) {
   return SDS011_PARSER_RES_RUNNING;
 }
 
+#endif // SDS011_PARSER_TABLE
+
+sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte) {
+  return parse_byte(parser, byte, parser->lazy ? NULL : &parser->msg);
+}
+
+static size_t parse_data_bytes(sds011_parser_t *parser, uint8_t const *buf, size_t len);
+
+size_t sds011_parser_parse_buffer(sds011_parser_t *parser, uint8_t const *buf, size_t len,
+                                  sds011_msg_t *msgs, size_t count, size_t *consumed) {
+  size_t iter = 0;
+  size_t ready = 0;
+
+  if (parser == NULL || buf == NULL || msgs == NULL) {
+    len = 0;
+  }
+
+  while (iter < len && ready < count) {
+    if (parser->state == STATE_BEG && buf[iter] != SDS011_FRAME_BEG) {
+      uint8_t const *beg = memchr(&buf[iter], SDS011_FRAME_BEG, len - iter);
+      size_t next = (beg != NULL) ? (size_t)(beg - buf) : len;
+      parser->error = SDS011_ERR_PARSER_FRAME_BEG;
+      parser->stats.skipped += (uint32_t)(next - iter);
+      iter = next;
+      continue;
+    }
+    if (parser->state == STATE_DATA) {
+      iter += parse_data_bytes(parser, &buf[iter], len - iter);
+      continue;
+    }
+    if (parse_byte(parser, buf[iter++], &msgs[ready]) == SDS011_PARSER_RES_READY) {
+      ready++;
+    }
+  }
+
+  if (consumed != NULL) {
+    *consumed = iter;
+  }
+  return ready;
+}
+
+static size_t parse_data_bytes(sds011_parser_t *parser, uint8_t const *buf, size_t len) {
+  size_t size = MIN((size_t)(parser->data_len - parser->data_iter), len);
+  uint8_t crc = parser->data_crc;
+
+  for (size_t i = 0; i < size; i++) {
+    crc += buf[i];
+  }
+  memcpy(&parser->data[parser->bank][parser->data_iter], buf, size);
+
+  parser->data_iter += (uint8_t)size;
+  parser->data_crc = crc;
+
+  if (parser->data_iter >= parser->data_len) {
+    parser->state++;
+  }
+  return size;
+}
+
 static uint8_t parser_data_len_by_cmd(uint8_t cmd) {
   if (cmd == SDS011_CMD_QUERY) {
     return SDS011_QUERY_DATA_SIZE;
@@ -84,20 +242,115 @@ static uint8_t parser_data_len_by_cmd(uint8_t cmd) {
   return 0;
 }
 
-static sds011_parser_res_t parser_error(sds011_parser_t *parser, uint32_t err_code) {
+static size_t parser_window(sds011_parser_t const *parser, uint8_t byte, uint8_t *window);
+static sds011_parser_res_t parser_rescan(sds011_parser_t *parser, uint8_t const *window,
+                                         size_t size, sds011_msg_t *msg);
+
+static void parser_count_error(sds011_parser_stats_t *stats, uint32_t err_code);
+
+static sds011_parser_res_t parser_error(sds011_parser_t *parser, uint32_t err_code,
+                                        uint8_t byte, sds011_msg_t *msg) {
+  uint8_t window[SDS011_QUERY_PACKET_SIZE];
+  size_t size = parser_window(parser, byte, window);
+
   parser_clear(parser);
+  parser_count_error(&parser->stats, err_code);
+
+  if (parser->resync == false) {
+    parser->stats.skipped += (uint32_t)size;
+    parser->error = err_code;
+    return SDS011_PARSER_RES_ERROR;
+  }
+
+  if (parser_rescan(parser, window, size, msg) == SDS011_PARSER_RES_READY) {
+    return SDS011_PARSER_RES_READY;
+  }
+
   parser->error = err_code;
   return SDS011_PARSER_RES_ERROR;
 }
 
-static sds011_err_t get_msg(sds011_parser_t const *parser, sds011_msg_t *msg);
+// Frame begin errors are not counted, the bytes are counted as skipped.
+static void parser_count_error(sds011_parser_stats_t *stats, uint32_t err_code) {
+  switch (err_code) {
+    case SDS011_ERR_PARSER_CMD:       stats->cmd_errors++;    break;
+    case SDS011_ERR_PARSER_CRC:       stats->crc_errors++;    break;
+    case SDS011_ERR_PARSER_FRAME_END: stats->end_errors++;    break;
+    case SDS011_ERR_INVALID_MSG_TYPE: stats->invalid_type++;  break;
+    case SDS011_ERR_INVALID_DATA:     stats->invalid_data++;  break;
+    default: break;
+  }
+}
+
+// Rebuild bytes of the dropped packet, including the failing byte.
+static size_t parser_window(sds011_parser_t const *parser, uint8_t byte, uint8_t *window) {
+  size_t size = 0;
 
-static sds011_parser_res_t parser_completed(sds011_parser_t *parser) {
+  if (parser->state > STATE_BEG) {
+    window[size++] = SDS011_FRAME_BEG;
+  }
+  if (parser->state > STATE_CMD) {
+    window[size++] = parser->cmd;
+    memcpy(&window[size], parser->data[parser->bank], parser->data_iter);
+    size += parser->data_iter;
+  }
+  if (parser->state > STATE_CRC) {
+    window[size++] = parser->data_crc;
+  }
+  window[size++] = byte;
+
+  return size;
+}
+
+// Skip to the next frame begin candidate in the window and parse the rest
+// of it again. Errors found in the window rescan their own bytes, so the
+// recursion depth is bounded by the window size. The window is shorter
+// than two packets, so at most one packet can be completed, the bytes of
+// the window following it are added to its frame tail.
+static sds011_parser_res_t parser_rescan(sds011_parser_t *parser, uint8_t const *window,
+                                         size_t size, sds011_msg_t *msg) {
+  sds011_parser_res_t result = SDS011_PARSER_RES_ERROR;
+  size_t iter = 1;
+
+  while (iter < size && window[iter] != SDS011_FRAME_BEG) {
+    iter++;
+  }
+  parser->stats.skipped += (uint32_t)iter;
+
+  for (; iter < size; iter++) {
+    if (parse_byte(parser, window[iter], msg) == SDS011_PARSER_RES_READY) {
+      parser->frame_tail += (uint8_t)(size - 1 - iter);
+      result = SDS011_PARSER_RES_READY;
+    }
+  }
+  return result;
+}
+
+static sds011_err_t check_frame(sds011_frame_t const *frame);
+static void decode_frame(sds011_frame_t const *frame, sds011_msg_t *msg);
+
+// The payload of a completed packet is kept in its bank until the next
+// packet is completed, new packets are collected in the other bank.
+static sds011_parser_res_t parser_completed(sds011_parser_t *parser, sds011_msg_t *msg) {
   sds011_parser_res_t result = SDS011_PARSER_RES_READY;
 
+  sds011_frame_t frame = {
+    .cmd  = parser->cmd,
+    .data = parser->data[parser->bank],
+  };
+
   sds011_err_t err_code;
-  if ((err_code = get_msg(parser, &parser->msg)) != SDS011_OK) {
+  if ((err_code = check_frame(&frame)) != SDS011_OK) {
+    parser_count_error(&parser->stats, err_code);
     result = SDS011_PARSER_RES_ERROR;
+  } else {
+    parser->stats.frames[sds011_frame_get_type(&frame)]++;
+    if (msg != NULL) {
+      decode_frame(&frame, msg);
+    }
+    parser->frame_cmd = parser->cmd;
+    parser->frame_tail = 0;
+    parser->bank ^= 1;
   }
 
   parser_clear(parser);
@@ -106,17 +359,32 @@ static sds011_parser_res_t parser_completed(sds011_parser_t *parser) {
   return result;
 }
 
-static sds011_msg_type_t get_msg_type(sds011_parser_t const *parser);
+// validators
+static sds011_err_t check_rep_mode(sds011_frame_t const *frame);
+static sds011_err_t check_sleep(sds011_frame_t const *frame);
+static sds011_err_t check_op_mode(sds011_frame_t const *frame);
+
+static sds011_err_t (*_msg_checks[9])(sds011_frame_t const *frame) = {
+  NULL,           // reserved
+  NULL,           // reserved
+  check_rep_mode,
+  NULL,           // reserved
+  NULL,           // data
+  NULL,           // dev id
+  check_sleep,
+  NULL,           // fw version
+  check_op_mode,
+};
 
 // parsers
-static sds011_err_t parse_rep_mode(sds011_parser_t const *parser, sds011_msg_t *msg);
-static sds011_err_t parse_data(sds011_parser_t const *parser, sds011_msg_t *msg);
-static sds011_err_t parse_dev_id(sds011_parser_t const *parser, sds011_msg_t *msg);
-static sds011_err_t parse_sleep(sds011_parser_t const *parser, sds011_msg_t *msg);
-static sds011_err_t parse_fw_ver(sds011_parser_t const *parser, sds011_msg_t *msg);
-static sds011_err_t parse_op_mode(sds011_parser_t const *parser, sds011_msg_t *msg);
-
-static sds011_err_t (*_msg_parsers[9])(sds011_parser_t const *parser, sds011_msg_t *msg) = {
+static void parse_rep_mode(sds011_frame_t const *frame, sds011_msg_t *msg);
+static void parse_data(sds011_frame_t const *frame, sds011_msg_t *msg);
+static void parse_dev_id(sds011_frame_t const *frame, sds011_msg_t *msg);
+static void parse_sleep(sds011_frame_t const *frame, sds011_msg_t *msg);
+static void parse_fw_ver(sds011_frame_t const *frame, sds011_msg_t *msg);
+static void parse_op_mode(sds011_frame_t const *frame, sds011_msg_t *msg);
+
+static void (*_msg_parsers[9])(sds011_frame_t const *frame, sds011_msg_t *msg) = {
   NULL,           // reserved
   NULL,           // reserved
   parse_rep_mode,
@@ -128,8 +396,12 @@ static sds011_err_t (*_msg_parsers[9])(sds011_parser_t const *parser, sds011_msg
   parse_op_mode,
 };
 
-static sds011_err_t get_msg(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  sds011_msg_type_t type = get_msg_type(parser);
+static sds011_err_t check_frame(sds011_frame_t const *frame) {
+  if (frame->cmd == SDS011_DAT_REPLY) {
+    return SDS011_OK; // sensor data reply has no fields to be checked
+  }
+
+  sds011_msg_type_t type = sds011_frame_get_type(frame);
 
   if (type >= SDS011_MSG_TYPE_COUNT) {
     return SDS011_ERR_INVALID_MSG_TYPE;
@@ -137,160 +409,224 @@ static sds011_err_t get_msg(sds011_parser_t const *parser, sds011_msg_t *msg) {
   if (_msg_parsers[type] == NULL) {
     return SDS011_ERR_INVALID_MSG_TYPE;
   }
+  if (_msg_checks[type] != NULL) {
+    return _msg_checks[type](frame);
+  }
+  return SDS011_OK;
+}
+
+static inline sds011_sample_t get_data_reply_sample(uint8_t const *data);
+static void decode_data_reply(sds011_frame_t const *frame, sds011_msg_t *msg);
+
+static void decode_frame(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  if (frame->cmd == SDS011_DAT_REPLY) {
+    decode_data_reply(frame, msg);
+    return;
+  }
+
+  sds011_msg_type_t type = sds011_frame_get_type(frame);
 
   memset(msg, 0, sizeof(sds011_msg_t));
-  return _msg_parsers[type](parser, msg);
+  msg->dev_id = sds011_frame_get_dev_id(frame);
+  msg->type   = type;
+  msg->src    = sds011_frame_get_src(frame);
+  _msg_parsers[type](frame, msg);
 }
 
-static sds011_msg_type_t get_msg_type(sds011_parser_t const *parser) {
-  if (parser->cmd == SDS011_DAT_REPLY) {
-    return SDS011_MSG_TYPE_DATA;
-  }
-  return parser->data[0];
+// Fast path for the sensor data reply, the most frequent packet in active
+// reporting mode. The message is assigned as a whole, members not set are
+// zeroed without a memset call.
+static void decode_data_reply(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  *msg = (sds011_msg_t) {
+    .dev_id       = VALUE16(frame->data[4], frame->data[5]),
+    .type         = SDS011_MSG_TYPE_DATA,
+    .op           = SDS011_MSG_OP_GET,
+    .src          = SDS011_MSG_SRC_SENSOR,
+    .data.sample  = get_data_reply_sample(frame->data),
+  };
 }
 
-static sds011_err_t parse_rep_mode(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  sds011_msg_op_t   op = (sds011_msg_op_t)  parser->data[1];
-  sds011_rep_mode_t rm = (sds011_rep_mode_t)parser->data[2];
+static inline sds011_sample_t get_data_reply_sample(uint8_t const *data) {
+  return (sds011_sample_t) {
+    .pm2_5 = VALUE16(data[1], data[0]),
+    .pm10  = VALUE16(data[3], data[2]),
+  };
+}
+
+static bool is_valid_op(uint8_t op) {
+  return op == SDS011_MSG_OP_GET || op == SDS011_MSG_OP_SET;
+}
 
-  if (op != SDS011_MSG_OP_GET && op != SDS011_MSG_OP_SET) {
+static sds011_err_t check_rep_mode(sds011_frame_t const *frame) {
+  sds011_rep_mode_t rm = (sds011_rep_mode_t)frame->data[2];
+
+  if (is_valid_op(frame->data[1]) == false) {
     return SDS011_ERR_INVALID_DATA;
   }
   if (rm != SDS011_REP_MODE_ACTIVE && rm != SDS011_REP_MODE_QUERY) {
     return SDS011_ERR_INVALID_DATA;
   }
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id               = VALUE16(parser->data[13], parser->data[14]);
-    msg->type                 = SDS011_MSG_TYPE_REP_MODE;
-    msg->op                   = op;
-    msg->src                  = SDS011_MSG_SRC_HOST;
-    msg->data.rep_mode        = rm;
-  } else {
-    msg->dev_id               = VALUE16(parser->data[4], parser->data[5]);
-    msg->type                 = SDS011_MSG_TYPE_REP_MODE;
-    msg->op                   = op;
-    msg->src                  = SDS011_MSG_SRC_SENSOR;
-    msg->data.rep_mode        = rm;
-  }
   return SDS011_OK;
 }
 
-static sds011_err_t parse_data(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id            = VALUE16(parser->data[13], parser->data[14]);
-    msg->type              = SDS011_MSG_TYPE_DATA;
-    msg->op                = SDS011_MSG_OP_GET;
-    msg->src               = SDS011_MSG_SRC_HOST;
-  } else {
-    msg->dev_id            = VALUE16(parser->data[4], parser->data[5]);
-    msg->type              = SDS011_MSG_TYPE_DATA;
-    msg->op                = SDS011_MSG_OP_GET;
-    msg->src               = SDS011_MSG_SRC_SENSOR;
-    msg->data.sample.pm2_5 = VALUE16(parser->data[1], parser->data[0]);
-    msg->data.sample.pm10  = VALUE16(parser->data[3], parser->data[2]);
-  }
-  return SDS011_OK;
-}
+static sds011_err_t check_sleep(sds011_frame_t const *frame) {
+  sds011_sleep_t sl = (sds011_sleep_t)frame->data[2];
 
-static sds011_err_t parse_dev_id(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id          = VALUE16(parser->data[13], parser->data[14]);
-    msg->type            = SDS011_MSG_TYPE_DEV_ID;
-    msg->op              = SDS011_MSG_OP_SET;
-    msg->src             = SDS011_MSG_SRC_HOST;
-    msg->data.new_dev_id = VALUE16(parser->data[11], parser->data[12]);
-  } else {
-    msg->dev_id            = VALUE16(parser->data[4], parser->data[5]);
-    msg->type              = SDS011_MSG_TYPE_DEV_ID;
-    msg->op                = SDS011_MSG_OP_SET;
-    msg->src               = SDS011_MSG_SRC_SENSOR;
+  if (is_valid_op(frame->data[1]) == false) {
+    return SDS011_ERR_INVALID_DATA;
+  }
+  if (sl != SDS011_SLEEP_ON && sl != SDS011_SLEEP_OFF) {
+    return SDS011_ERR_INVALID_DATA;
   }
   return SDS011_OK;
 }
 
-static sds011_err_t parse_sleep(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  sds011_msg_op_t op = (sds011_msg_op_t)parser->data[1];
-  sds011_sleep_t  sl = (sds011_sleep_t) parser->data[2];
+static sds011_err_t check_op_mode(sds011_frame_t const *frame) {
+  const uint8_t max_interval = 30;
 
-  if (op != SDS011_MSG_OP_GET && op != SDS011_MSG_OP_SET) {
+  if (is_valid_op(frame->data[1]) == false) {
     return SDS011_ERR_INVALID_DATA;
   }
-  if (sl != SDS011_SLEEP_ON && sl != SDS011_SLEEP_OFF) {
+  if (frame->data[2] > max_interval) {
     return SDS011_ERR_INVALID_DATA;
   }
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id     = VALUE16(parser->data[13], parser->data[14]);
-    msg->type       = SDS011_MSG_TYPE_SLEEP;
-    msg->op         = op;
-    msg->src        = SDS011_MSG_SRC_HOST;
-    msg->data.sleep = sl;
-  } else {
-    msg->dev_id     = VALUE16(parser->data[4], parser->data[5]);
-    msg->type       = SDS011_MSG_TYPE_SLEEP;
-    msg->op         = op;
-    msg->src        = SDS011_MSG_SRC_SENSOR;
-    msg->data.sleep = sl;
-  }
   return SDS011_OK;
 }
 
-static sds011_err_t parse_fw_ver(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id             = VALUE16(parser->data[13], parser->data[14]);
-    msg->type               = SDS011_MSG_TYPE_FW_VER;
-    msg->op                 = SDS011_MSG_OP_GET;
-    msg->src                = SDS011_MSG_SRC_HOST;
-  } else {
-    msg->dev_id             = VALUE16(parser->data[4], parser->data[5]);
-    msg->type               = SDS011_MSG_TYPE_FW_VER;
-    msg->op                 = SDS011_MSG_OP_GET;
-    msg->src                = SDS011_MSG_SRC_SENSOR;
-    msg->data.fw_ver.year   = parser->data[1];
-    msg->data.fw_ver.month  = parser->data[2];
-    msg->data.fw_ver.day    = parser->data[3];
-  }
-  return SDS011_OK;
+static void parse_rep_mode(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  msg->op             = (sds011_msg_op_t)  frame->data[1];
+  msg->data.rep_mode  = (sds011_rep_mode_t)frame->data[2];
 }
 
-static sds011_err_t parse_op_mode(sds011_parser_t const *parser, sds011_msg_t *msg) {
-  const uint8_t max_interval = 30;
-
-  sds011_msg_op_t op = (sds011_msg_op_t)parser->data[1];
-  uint8_t interval = parser->data[2];
-  uint8_t mode = SDS011_OP_MODE_CONTINOUS;
+static void parse_data(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  msg->op           = SDS011_MSG_OP_GET;
+  msg->data.sample  = sds011_frame_get_sample(frame);
+}
 
-  if (op != SDS011_MSG_OP_GET && op != SDS011_MSG_OP_SET) {
-    return SDS011_ERR_INVALID_DATA;
-  }
-  if (interval > max_interval) {
-    return SDS011_ERR_INVALID_DATA;
-  }
-  if (interval != 0) {
-    mode = SDS011_OP_MODE_INTERVAL;
+static void parse_dev_id(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  msg->op = SDS011_MSG_OP_SET;
+  if (frame->cmd == SDS011_CMD_QUERY) {
+    msg->data.new_dev_id = VALUE16(frame->data[11], frame->data[12]);
   }
+}
 
-  if (parser->cmd == SDS011_CMD_QUERY) {
-    msg->dev_id                 = VALUE16(parser->data[13], parser->data[14]);
-    msg->type                   = SDS011_MSG_TYPE_OP_MODE;
-    msg->op                     = op;
-    msg->src                    = SDS011_MSG_SRC_HOST;
-    msg->data.op_mode.mode      = mode;
-    msg->data.op_mode.interval  = interval;
-  } else {
-    msg->dev_id                 = VALUE16(parser->data[4], parser->data[5]);
-    msg->type                   = SDS011_MSG_TYPE_OP_MODE;
-    msg->op                     = op;
-    msg->src                    = SDS011_MSG_SRC_SENSOR;
-    msg->data.op_mode.mode      = mode;
-    msg->data.op_mode.interval  = interval;
+static void parse_sleep(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  msg->op         = (sds011_msg_op_t)frame->data[1];
+  msg->data.sleep = (sds011_sleep_t) frame->data[2];
+}
+
+static void parse_fw_ver(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  msg->op = SDS011_MSG_OP_GET;
+  if (frame->cmd != SDS011_CMD_QUERY) {
+    msg->data.fw_ver.year   = frame->data[1];
+    msg->data.fw_ver.month  = frame->data[2];
+    msg->data.fw_ver.day    = frame->data[3];
   }
-  return SDS011_OK;
 }
 
+static void parse_op_mode(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  uint8_t interval = frame->data[2];
+
+  msg->op                     = (sds011_msg_op_t)frame->data[1];
+  msg->data.op_mode.mode      = interval != 0 ? SDS011_OP_MODE_INTERVAL : SDS011_OP_MODE_CONTINOUS;
+  msg->data.op_mode.interval  = interval;
+}
+
+// In lazy mode the message is left zeroed until a packet is completed,
+// same as the message kept by the parser in the default mode.
 void sds011_parser_get_msg(sds011_parser_t const *parser, sds011_msg_t *msg) {
+  if (parser->lazy) {
+    sds011_frame_t frame;
+    sds011_parser_get_frame(parser, &frame);
+    if (frame.cmd == 0 || check_frame(&frame) != SDS011_OK) {
+      memset(msg, 0, sizeof(sds011_msg_t));
+      return;
+    }
+    decode_frame(&frame, msg);
+    return;
+  }
   memcpy(msg, &parser->msg, sizeof(sds011_msg_t));
 }
 
+void sds011_parser_get_frame(sds011_parser_t const *parser, sds011_frame_t *frame) {
+  frame->cmd  = parser->frame_cmd;
+  frame->data = parser->data[parser->bank ^ 1];
+}
+
+bool sds011_parser_get_sample(sds011_parser_t const *parser,
+                              uint16_t *dev_id, sds011_sample_t *sample) {
+  uint8_t const *data = parser->data[parser->bank ^ 1];
+
+  if (parser->frame_cmd != SDS011_DAT_REPLY) {
+    return false;
+  }
+  *dev_id = VALUE16(data[4], data[5]);
+  *sample = get_data_reply_sample(data);
+  return true;
+}
+
 sds011_err_t sds011_parser_get_error(sds011_parser_t const *parser) {
   return parser->error;
 }
+
+size_t sds011_parser_get_frame_tail(sds011_parser_t const *parser) {
+  return parser->frame_tail;
+}
+
+uint32_t sds011_parser_get_skipped(sds011_parser_t const *parser) {
+  return parser->stats.skipped;
+}
+
+void sds011_parser_get_stats(sds011_parser_t const *parser, sds011_parser_stats_t *stats) {
+  memcpy(stats, &parser->stats, sizeof(sds011_parser_stats_t));
+}
+
+void sds011_parser_reset_stats(sds011_parser_t *parser) {
+  memset(&parser->stats, 0, sizeof(sds011_parser_stats_t));
+}
+
+void sds011_frame_init(sds011_frame_t *frame, uint8_t const *packet) {
+  frame->cmd  = packet[1];
+  frame->data = &packet[2];
+}
+
+sds011_msg_type_t sds011_frame_get_type(sds011_frame_t const *frame) {
+  if (frame->cmd == SDS011_DAT_REPLY) {
+    return SDS011_MSG_TYPE_DATA;
+  }
+  return (sds011_msg_type_t)frame->data[0];
+}
+
+sds011_msg_src_t sds011_frame_get_src(sds011_frame_t const *frame) {
+  if (frame->cmd == SDS011_CMD_QUERY) {
+    return SDS011_MSG_SRC_HOST;
+  }
+  return SDS011_MSG_SRC_SENSOR;
+}
+
+uint16_t sds011_frame_get_dev_id(sds011_frame_t const *frame) {
+  if (frame->cmd == SDS011_CMD_QUERY) {
+    return VALUE16(frame->data[13], frame->data[14]);
+  }
+  return VALUE16(frame->data[4], frame->data[5]);
+}
+
+sds011_sample_t sds011_frame_get_sample(sds011_frame_t const *frame) {
+  sds011_sample_t sample = { 0, 0 };
+
+  if (sds011_frame_get_type(frame) == SDS011_MSG_TYPE_DATA &&
+      sds011_frame_get_src(frame) == SDS011_MSG_SRC_SENSOR) {
+    sample = get_data_reply_sample(frame->data);
+  }
+  return sample;
+}
+
+sds011_err_t sds011_frame_get_msg(sds011_frame_t const *frame, sds011_msg_t *msg) {
+  sds011_err_t err_code;
+
+  if ((err_code = check_frame(frame)) != SDS011_OK) {
+    return err_code;
+  }
+  decode_frame(frame, msg);
+  return SDS011_OK;
+}
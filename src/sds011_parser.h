@@ -1,6 +1,7 @@
 #ifndef SDS011_PARSER_H__
 #define SDS011_PARSER_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -10,23 +11,75 @@
 extern "C" {
 #endif
 
+/**
+ * Parser statistics, counted since sds011_parser_init or the latest
+ * sds011_parser_reset_stats call.
+ */
+typedef struct {
+  uint32_t frames[SDS011_MSG_TYPE_COUNT]; // valid packets by message type
+  uint32_t crc_errors;                    // checksum mismatches
+  uint32_t cmd_errors;                    // unknown command bytes
+  uint32_t end_errors;                    // missing frame end bytes
+  uint32_t invalid_type;                  // unknown message types
+  uint32_t invalid_data;                  // invalid message fields
+  uint32_t skipped;                       // bytes skipped while out of sync
+} sds011_parser_stats_t;
+
 typedef struct {
   uint8_t state;
   uint8_t cmd;
   uint8_t data_len;
   uint8_t data_iter;
   uint8_t data_crc;
-  uint8_t data[SDS011_MAX_DATA_SIZE];
+  uint8_t data[2][SDS011_MAX_DATA_SIZE];
+  uint8_t bank;
+  uint8_t frame_cmd;
+  uint8_t frame_tail; // bytes parsed after the end of the latest packet
   sds011_err_t error;
   sds011_msg_t msg;
+  bool resync;
+  bool lazy;
+  sds011_parser_stats_t stats;
 } sds011_parser_t;
 
+/**
+ * View of a validated packet. Fields are decoded only when read with the
+ * sds011_frame_get_* functions.
+ */
+typedef struct {
+  uint8_t cmd;
+  uint8_t const *data;
+} sds011_frame_t;
+
 /**
  * Initialize SDS011 parser
  * @param[in] parser SDS011 parser structure
  */
 void sds011_parser_init(sds011_parser_t *parser);
 
+/**
+ * @brief Enable or disable resynchronization (disabled by default).
+ *        Without resynchronization the bytes of an invalid packet are
+ *        dropped. With resynchronization enabled the parser rescans the
+ *        bytes of the invalid packet, including the failing byte, for the
+ *        next frame begin, so a corrupted byte costs only the packet it
+ *        belongs to.
+ * @param[in] parser SDS011 parser structure
+ * @param[in] enable true to enable resynchronization
+ */
+void sds011_parser_set_resync(sds011_parser_t *parser, bool enable);
+
+/**
+ * @brief Enable or disable lazy decoding (disabled by default).
+ *        With lazy decoding packets are only validated when completed,
+ *        the message is decoded when sds011_parser_get_msg is called.
+ *        Use sds011_parser_get_frame to read single fields without
+ *        decoding the whole message.
+ * @param[in] parser SDS011 parser structure
+ * @param[in] enable true to enable lazy decoding
+ */
+void sds011_parser_set_lazy(sds011_parser_t *parser, bool enable);
+
 /**
  * @brief Parse single byte coming from SDS011 device.
  *        This function returns SDS011_PARSER_RES_RUNNING until entire packet
@@ -43,6 +96,28 @@ void sds011_parser_init(sds011_parser_t *parser);
  */
 sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte);
 
+/**
+ * @brief Parse a buffer of bytes coming from SDS011 device.
+ *        Every complete packet found in the buffer is decoded and stored in
+ *        the msgs array. Parsing stops when the buffer is exhausted or the
+ *        msgs array is full, the number of processed bytes is returned via
+ *        the consumed parameter, so the remaining bytes can be passed in the
+ *        next call. Partial packets are kept in the parser state between
+ *        calls. Invalid packets are dropped, the latest error can be
+ *        retrieved using sds011_parser_get_error function.
+ *        Messages are written to the msgs array only, the message returned
+ *        by sds011_parser_get_msg is not updated.
+ * @param[in]  parser SDS011 parser structure
+ * @param[in]  buf data to be parsed
+ * @param[in]  len size of the data
+ * @param[out] msgs decoded messages
+ * @param[in]  count maximum number of messages
+ * @param[out] consumed number of processed bytes, can be NULL
+ * @return number of decoded messages
+ */
+size_t sds011_parser_parse_buffer(sds011_parser_t *parser, uint8_t const *buf, size_t len,
+                                  sds011_msg_t *msgs, size_t count, size_t *consumed);
+
 /**
  * Get latest message
  * @param[in]  parser SDS011 parser structure
@@ -50,6 +125,26 @@ sds011_parser_res_t sds011_parser_parse(sds011_parser_t *parser, uint8_t byte);
  */
 void sds011_parser_get_msg(sds011_parser_t const *parser, sds011_msg_t *msg);
 
+/**
+ * Get view of the latest packet. The view stays valid until the next
+ * packet is completed by the parser.
+ * @param[in]  parser SDS011 parser structure
+ * @param[out] frame latest packet
+ */
+void sds011_parser_get_frame(sds011_parser_t const *parser, sds011_frame_t *frame);
+
+/**
+ * @brief Get sample of the latest packet without decoding the message.
+ *        Fast path for active reporting mode, where almost every packet is
+ *        a sensor data reply.
+ * @param[in]  parser SDS011 parser structure
+ * @param[out] dev_id device id
+ * @param[out] sample sample
+ * @return true if the latest packet is a sensor data reply, otherwise false
+ */
+bool sds011_parser_get_sample(sds011_parser_t const *parser,
+                              uint16_t *dev_id, sds011_sample_t *sample);
+
 /**
  * Get latest error
  * @param[in] parser SDS011 parser structure
@@ -57,6 +152,87 @@ void sds011_parser_get_msg(sds011_parser_t const *parser, sds011_msg_t *msg);
  */
 sds011_err_t sds011_parser_get_error(sds011_parser_t const *parser);
 
+/**
+ * Get the number of bytes parsed after the end of the latest packet by
+ * the call which completed it. Non-zero only when the packet was found
+ * by resynchronization within the bytes of a dropped packet, the packet
+ * then ends before the byte which completed it.
+ * @param[in] parser SDS011 parser structure
+ * @return number of bytes between the end of the packet and the byte
+ *         which completed it
+ */
+size_t sds011_parser_get_frame_tail(sds011_parser_t const *parser);
+
+/**
+ * Get number of bytes skipped while out of sync
+ * @param[in] parser SDS011 parser structure
+ * @return number of bytes not belonging to any valid packet
+ */
+uint32_t sds011_parser_get_skipped(sds011_parser_t const *parser);
+
+/**
+ * @brief Get parser statistics.
+ *        Unlike sds011_parser_get_error, which reports the latest error
+ *        only, the counters accumulate every packet and error seen by the
+ *        parser. Line noise shows up as skipped bytes and CRC errors,
+ *        a protocol mismatch as command, message type or data errors.
+ *        Packets dropped by a rescan in resynchronization mode are counted
+ *        with the error which dropped them.
+ * @param[in]  parser SDS011 parser structure
+ * @param[out] stats parser statistics
+ */
+void sds011_parser_get_stats(sds011_parser_t const *parser, sds011_parser_stats_t *stats);
+
+/**
+ * Reset parser statistics
+ * @param[in] parser SDS011 parser structure
+ */
+void sds011_parser_reset_stats(sds011_parser_t *parser);
+
+/**
+ * Initialize view of a raw packet, e.g. found by sds011_scanner_scan.
+ * The packet has to be validated before.
+ * @param[out] frame packet view
+ * @param[in]  packet raw packet, starting with the frame begin byte
+ */
+void sds011_frame_init(sds011_frame_t *frame, uint8_t const *packet);
+
+/**
+ * Get message type
+ * @param[in] frame packet view
+ * @return message type
+ */
+sds011_msg_type_t sds011_frame_get_type(sds011_frame_t const *frame);
+
+/**
+ * Get message source
+ * @param[in] frame packet view
+ * @return message source
+ */
+sds011_msg_src_t sds011_frame_get_src(sds011_frame_t const *frame);
+
+/**
+ * Get device id
+ * @param[in] frame packet view
+ * @return device id
+ */
+uint16_t sds011_frame_get_dev_id(sds011_frame_t const *frame);
+
+/**
+ * Get sample, both values are 0 if the packet is not a sensor data reply
+ * @param[in] frame packet view
+ * @return sample
+ */
+sds011_sample_t sds011_frame_get_sample(sds011_frame_t const *frame);
+
+/**
+ * Decode entire message
+ * @param[in]  frame packet view
+ * @param[out] msg decoded message
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_frame_get_msg(sds011_frame_t const *frame, sds011_msg_t *msg);
+
 #ifdef __cplusplus
 }
 #endif
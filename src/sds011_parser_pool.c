@@ -0,0 +1,171 @@
+#include "sds011_parser_pool.h"
+#include "sds011_parser.h"
+
+#include <string.h>
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+enum {
+  STATE_BEG,
+  STATE_CMD,
+  STATE_DATA,
+  STATE_CRC,
+  STATE_END,
+};
+
+sds011_err_t sds011_parser_pool_init(sds011_parser_pool_t *pool, size_t streams) {
+  if (pool == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  if (streams > SDS011_PARSER_POOL_SIZE) { return SDS011_ERR_INVALID_PARAM; }
+
+  memset(pool->state,     STATE_BEG, streams);
+  memset(pool->cmd,       0,         streams);
+  memset(pool->data_iter, 0,         streams);
+  memset(pool->data_crc,  0,         streams);
+  memset(pool->error,     SDS011_OK, streams);
+  pool->streams = streams;
+
+  return SDS011_OK;
+}
+
+static size_t parse_stream(sds011_parser_pool_t *pool, sds011_parser_pool_chunk_t *chunk,
+                           sds011_parser_pool_msg_t *msgs, size_t count);
+
+size_t sds011_parser_pool_parse(sds011_parser_pool_t *pool,
+                                sds011_parser_pool_chunk_t *chunks, size_t chunks_count,
+                                sds011_parser_pool_msg_t *msgs, size_t count) {
+  size_t ready = 0;
+
+  if (pool == NULL || chunks == NULL || msgs == NULL) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < chunks_count && ready < count; i++) {
+    if (chunks[i].stream >= pool->streams || chunks[i].buf == NULL) {
+      continue;
+    }
+    ready += parse_stream(pool, &chunks[i], &msgs[ready], count - ready);
+  }
+  return ready;
+}
+
+static inline uint8_t data_len_by_cmd(uint8_t cmd) {
+  if (cmd == SDS011_CMD_QUERY) {
+    return SDS011_QUERY_DATA_SIZE;
+  }
+  if (cmd == SDS011_CMD_REPLY || cmd == SDS011_DAT_REPLY) {
+    return SDS011_REPLY_DATA_SIZE;
+  }
+  return 0;
+}
+
+// The failing byte starts the next packet if it is a frame begin.
+static inline uint8_t next_state(uint8_t byte) {
+  return byte == SDS011_FRAME_BEG ? STATE_CMD : STATE_BEG;
+}
+
+// The stream state is loaded into locals for the whole chunk and stored
+// back once, only the payload is written to the pool directly.
+static size_t parse_stream(sds011_parser_pool_t *pool, sds011_parser_pool_chunk_t *chunk,
+                           sds011_parser_pool_msg_t *msgs, size_t count) {
+  uint16_t s = chunk->stream;
+  uint8_t const *buf = chunk->buf;
+  size_t len = chunk->len;
+
+  uint8_t state = pool->state[s];
+  uint8_t cmd   = pool->cmd[s];
+  uint8_t iter  = pool->data_iter[s];
+  uint8_t crc   = pool->data_crc[s];
+  uint8_t error = pool->error[s];
+  uint8_t *data = pool->data[s];
+
+  size_t pos = 0;
+  size_t ready = 0;
+
+  while (pos < len && ready < count) {
+    uint8_t byte;
+    uint8_t data_len;
+    sds011_err_t err_code;
+
+    switch (state) {
+      case STATE_BEG:
+        if (buf[pos] != SDS011_FRAME_BEG) {
+          uint8_t const *beg = memchr(&buf[pos], SDS011_FRAME_BEG, len - pos);
+          pos = (beg != NULL) ? (size_t)(beg - buf) : len;
+          error = SDS011_ERR_PARSER_FRAME_BEG;
+          break;
+        }
+        pos++;
+        state = STATE_CMD;
+        break;
+      case STATE_CMD:
+        byte = buf[pos++];
+        if (data_len_by_cmd(byte) == 0) {
+          error = SDS011_ERR_PARSER_CMD;
+          state = next_state(byte);
+          break;
+        }
+        cmd = byte;
+        iter = 0;
+        crc = 0;
+        state = STATE_DATA;
+        break;
+      case STATE_DATA:
+        data_len = data_len_by_cmd(cmd);
+        for (size_t size = MIN((size_t)(data_len - iter), len - pos); size > 0; size--) {
+          crc += buf[pos];
+          data[iter++] = buf[pos++];
+        }
+        if (iter >= data_len) {
+          state = STATE_CRC;
+        }
+        break;
+      case STATE_CRC:
+        byte = buf[pos++];
+        if (byte != crc) {
+          error = SDS011_ERR_PARSER_CRC;
+          state = next_state(byte);
+          break;
+        }
+        state = STATE_END;
+        break;
+      case STATE_END:
+        byte = buf[pos++];
+        if (byte != SDS011_FRAME_END) {
+          error = SDS011_ERR_PARSER_FRAME_END;
+          state = next_state(byte);
+          break;
+        }
+        err_code = sds011_frame_get_msg(&(sds011_frame_t) {
+          .cmd  = cmd,
+          .data = data,
+        }, &msgs[ready].msg);
+        if (err_code == SDS011_OK) {
+          msgs[ready++].stream = s;
+        }
+        error = (uint8_t)err_code;
+        state = STATE_BEG;
+        break;
+      default:
+        state = STATE_BEG;
+        break;
+    }
+  }
+
+  pool->state[s]     = state;
+  pool->cmd[s]       = cmd;
+  pool->data_iter[s] = iter;
+  pool->data_crc[s]  = crc;
+  pool->error[s]     = error;
+
+  chunk->buf = &buf[pos];
+  chunk->len = len - pos;
+
+  return ready;
+}
+
+sds011_err_t sds011_parser_pool_get_error(sds011_parser_pool_t const *pool, uint16_t stream) {
+  if (stream >= pool->streams) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+  return (sds011_err_t)pool->error[stream];
+}
@@ -0,0 +1,88 @@
+#ifndef SDS011_PARSER_POOL_H__
+#define SDS011_PARSER_POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sds011_config.h"
+#include "sds011_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Parser state of up to SDS011_PARSER_POOL_SIZE streams, stored as
+ * separate arrays indexed by the stream id.
+ */
+typedef struct {
+  uint8_t state[SDS011_PARSER_POOL_SIZE];
+  uint8_t cmd[SDS011_PARSER_POOL_SIZE];
+  uint8_t data_iter[SDS011_PARSER_POOL_SIZE];
+  uint8_t data_crc[SDS011_PARSER_POOL_SIZE];
+  uint8_t error[SDS011_PARSER_POOL_SIZE];
+  uint8_t data[SDS011_PARSER_POOL_SIZE][SDS011_MAX_DATA_SIZE];
+  size_t streams;
+} sds011_parser_pool_t;
+
+/**
+ * Bytes received from a single stream.
+ */
+typedef struct {
+  uint16_t stream;
+  uint8_t const *buf;
+  size_t len;
+} sds011_parser_pool_chunk_t;
+
+/**
+ * Message decoded from a stream.
+ */
+typedef struct {
+  uint16_t stream;
+  sds011_msg_t msg;
+} sds011_parser_pool_msg_t;
+
+/**
+ * Initialize parser pool
+ * @param[in] pool parser pool structure
+ * @param[in] streams number of streams, at most SDS011_PARSER_POOL_SIZE
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_parser_pool_init(sds011_parser_pool_t *pool, size_t streams);
+
+/**
+ * @brief Parse chunks of bytes coming from many streams.
+ *        Chunks are parsed in order, every stream keeps its partial packet
+ *        between chunks and calls. Complete packets are decoded and stored
+ *        in the msgs array, tagged with the stream id. Processed bytes are
+ *        removed from the chunks (buf and len are advanced), so when the
+ *        msgs array gets full the function can be called again with the
+ *        same chunks. Chunks of unknown streams are left untouched.
+ *        Invalid packets are dropped, the latest error of a stream can be
+ *        retrieved using sds011_parser_pool_get_error. A frame begin byte
+ *        which fails a packet starts the next packet.
+ * @param[in]     pool parser pool structure
+ * @param[in,out] chunks received bytes
+ * @param[in]     chunks_count number of chunks
+ * @param[out]    msgs decoded messages
+ * @param[in]     count maximum number of messages
+ * @return number of decoded messages
+ */
+size_t sds011_parser_pool_parse(sds011_parser_pool_t *pool,
+                                sds011_parser_pool_chunk_t *chunks, size_t chunks_count,
+                                sds011_parser_pool_msg_t *msgs, size_t count);
+
+/**
+ * Get latest error of a stream
+ * @param[in] pool parser pool structure
+ * @param[in] stream stream id
+ * @return latest error
+ */
+sds011_err_t sds011_parser_pool_get_error(sds011_parser_pool_t const *pool, uint16_t stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_PARSER_POOL_H__
@@ -0,0 +1,107 @@
+#ifndef SDS011_RING_H__
+#define SDS011_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/**
+ * Smallest power of two not less than n, for n up to 65536
+ */
+#define SDS011_RING_POW2(n)                                               \
+  ((n) <= 1 ? 1 : (n) <= 2 ? 2 : (n) <= 4 ? 4 : (n) <= 8 ? 8 :            \
+   (n) <= 16 ? 16 : (n) <= 32 ? 32 : (n) <= 64 ? 64 : (n) <= 128 ? 128 :  \
+   (n) <= 256 ? 256 : (n) <= 512 ? 512 : (n) <= 1024 ? 1024 :             \
+   (n) <= 2048 ? 2048 : (n) <= 4096 ? 4096 : (n) <= 8192 ? 8192 :         \
+   (n) <= 16384 ? 16384 : (n) <= 32768 ? 32768 : 65536)
+
+/**
+ * @brief Declare typed ring.
+ *        Unlike sds011_fifo_t the element type and the capacity are known
+ *        at compile time, elements are moved with struct assignment and
+ *        indices wrap with a mask. Indices run freely, so all slots can be
+ *        used. The number of queued elements can be further limited at
+ *        runtime with the limit passed to name_init.
+ *
+ *        Declares type name_t and functions:
+ *        - void name_init(name_t *ring, size_t limit)
+ *        - bool name_push(name_t *ring, type const *el)
+ *        - bool name_pop(name_t *ring, type *el)
+ *        - size_t name_count(name_t const *ring)
+ *        - type *name_reserve(name_t *ring), slot for the next element or
+ *          NULL if full, the element is added by name_commit
+ *        - bool name_commit(name_t *ring)
+ *        - type *name_peek(name_t *ring), oldest element or NULL if empty,
+ *          valid until the element is removed by name_release
+ *        - bool name_release(name_t *ring)
+ * @param name ring name
+ * @param type element type
+ * @param capacity number of slots, power of two
+ */
+#define SDS011_RING_DECLARE(name, type, capacity)                                 \
+  typedef struct {                                                               \
+    type mem[capacity];                                                          \
+    size_t beg, end;                                                             \
+    size_t limit;                                                                \
+  } name##_t;                                                                    \
+                                                                                 \
+  static inline void name##_init(name##_t *ring, size_t limit) {                 \
+    ring->beg = ring->end = 0;                                                   \
+    ring->limit = limit < (capacity) ? limit : (capacity);                       \
+  }                                                                              \
+                                                                                 \
+  static inline size_t name##_count(name##_t const *ring) {                      \
+    return ring->end - ring->beg;                                                \
+  }                                                                              \
+                                                                                 \
+  static inline bool name##_push(name##_t *ring, type const *el) {               \
+    if (name##_count(ring) >= ring->limit) {                                     \
+      return false;                                                              \
+    }                                                                            \
+    ring->mem[ring->end++ & ((capacity) - 1)] = *el;                             \
+    return true;                                                                 \
+  }                                                                              \
+                                                                                 \
+  static inline bool name##_pop(name##_t *ring, type *el) {                      \
+    if (ring->beg == ring->end) {                                                \
+      return false;                                                              \
+    }                                                                            \
+    *el = ring->mem[ring->beg++ & ((capacity) - 1)];                             \
+    return true;                                                                 \
+  }                                                                              \
+                                                                                 \
+  static inline type *name##_reserve(name##_t *ring) {                           \
+    if (name##_count(ring) >= ring->limit) {                                     \
+      return NULL;                                                               \
+    }                                                                            \
+    return &ring->mem[ring->end & ((capacity) - 1)];                             \
+  }                                                                              \
+                                                                                 \
+  static inline bool name##_commit(name##_t *ring) {                             \
+    if (name##_count(ring) >= ring->limit) {                                     \
+      return false;                                                              \
+    }                                                                            \
+    ring->end++;                                                                 \
+    return true;                                                                 \
+  }                                                                              \
+                                                                                 \
+  static inline type *name##_peek(name##_t *ring) {                              \
+    if (ring->beg == ring->end) {                                                \
+      return NULL;                                                               \
+    }                                                                            \
+    return &ring->mem[ring->beg & ((capacity) - 1)];                             \
+  }                                                                              \
+                                                                                 \
+  static inline bool name##_release(name##_t *ring) {                            \
+    if (ring->beg == ring->end) {                                                \
+      return false;                                                              \
+    }                                                                            \
+    ring->beg++;                                                                 \
+    return true;                                                                 \
+  }                                                                              \
+                                                                                 \
+  static_assert((capacity) > 0 && ((capacity) & ((capacity) - 1)) == 0,          \
+                #name " capacity has to be a power of two")
+
+#endif // SDS011_RING_H__
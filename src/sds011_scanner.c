@@ -0,0 +1,189 @@
+#include "sds011_scanner.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define SCANNER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#define SCANNER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#define SCANNER_BATCH 16
+
+static inline size_t frame_size(uint8_t cmd) {
+  if (cmd == SDS011_CMD_QUERY) {
+    return SDS011_QUERY_PACKET_SIZE;
+  }
+  if (cmd == SDS011_CMD_REPLY || cmd == SDS011_DAT_REPLY) {
+    return SDS011_REPLY_PACKET_SIZE;
+  }
+  return 0;
+}
+
+size_t sds011_scanner_find(uint8_t const *buf, size_t len) {
+  size_t iter = 0;
+
+#if defined(SCANNER_AVX2)
+  const __m256i beg32 = _mm256_set1_epi8((char)SDS011_FRAME_BEG);
+  for (; iter + 32 <= len; iter += 32) {
+    __m256i v = _mm256_loadu_si256((__m256i const *)&buf[iter]);
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, beg32));
+    if (mask != 0) {
+      return iter + (size_t)__builtin_ctz(mask);
+    }
+  }
+#endif
+
+#if defined(SCANNER_SSE2)
+  const __m128i beg16 = _mm_set1_epi8((char)SDS011_FRAME_BEG);
+  for (; iter + 16 <= len; iter += 16) {
+    __m128i v = _mm_loadu_si128((__m128i const *)&buf[iter]);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, beg16));
+    if (mask != 0) {
+      return iter + (size_t)__builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; iter < len; iter++) {
+    if (buf[iter] == SDS011_FRAME_BEG) {
+      break;
+    }
+  }
+  return iter;
+}
+
+// Sum of the packet payload. The loads stay within the packet: the query
+// payload is followed by the CRC byte, the reply payload by CRC and frame
+// end bytes.
+static inline uint8_t checksum(uint8_t const *data, size_t size) {
+#if defined(SCANNER_SSE2)
+  const __m128i query_mask = _mm_setr_epi8(
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0);
+  const __m128i reply_mask = _mm_setr_epi8(
+    -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  __m128i v;
+  if (size == SDS011_QUERY_DATA_SIZE) {
+    v = _mm_and_si128(_mm_loadu_si128((__m128i const *)data), query_mask);
+  } else {
+    v = _mm_and_si128(_mm_loadl_epi64((__m128i const *)data), reply_mask);
+  }
+  __m128i sad = _mm_sad_epu8(v, _mm_setzero_si128());
+  return (uint8_t)(_mm_cvtsi128_si32(sad) + _mm_extract_epi16(sad, 4));
+#else
+  uint8_t crc = 0;
+  for (size_t i = 0; i < size; i++) {
+    crc += data[i];
+  }
+  return crc;
+#endif
+}
+
+static inline sds011_err_t check_frame(uint8_t const *buf, size_t size) {
+  size_t data_size = size - SDS011_META_DATA_SIZE;
+
+  if (checksum(&buf[2], data_size) != buf[size - 2]) {
+    return SDS011_ERR_PARSER_CRC;
+  }
+  if (buf[size - 1] != SDS011_FRAME_END) {
+    return SDS011_ERR_PARSER_FRAME_END;
+  }
+  return SDS011_OK;
+}
+
+sds011_err_t sds011_scanner_check(uint8_t const *buf, size_t len) {
+  if (buf == NULL || len < 2) {
+    return SDS011_ERR_MEM;
+  }
+  if (buf[0] != SDS011_FRAME_BEG) {
+    return SDS011_ERR_PARSER_FRAME_BEG;
+  }
+
+  size_t size = frame_size(buf[1]);
+  if (size == 0) {
+    return SDS011_ERR_PARSER_CMD;
+  }
+  if (size > len) {
+    return SDS011_ERR_MEM;
+  }
+  return check_frame(buf, size);
+}
+
+size_t sds011_scanner_scan(uint8_t const *buf, size_t len,
+                           size_t *offsets, size_t count, size_t *consumed) {
+  size_t found = 0;
+  size_t iter = 0;
+  size_t next = 0; // end of the latest valid packet
+  size_t stop = len;
+
+  if (buf == NULL || offsets == NULL) {
+    len = stop = 0;
+  }
+
+  while (iter < len && found < count) {
+    size_t cand[SCANNER_BATCH];
+    size_t size[SCANNER_BATCH];
+    size_t n = 0;
+    size_t incomplete = len;
+
+    // collect candidates with a valid command which fit in the buffer
+    while (n < SCANNER_BATCH) {
+      iter += sds011_scanner_find(&buf[iter], len - iter);
+      if (iter >= len) {
+        break;
+      }
+      if (iter + 1 >= len) {
+        incomplete = iter;
+        break;
+      }
+      size_t s = frame_size(buf[iter + 1]);
+      if (s != 0 && iter + s > len) {
+        incomplete = iter;
+        break;
+      }
+      if (s != 0) {
+        cand[n] = iter;
+        size[n] = s;
+        n++;
+      }
+      iter++;
+    }
+
+    // verify checksums of the whole batch, one SAD per candidate
+    for (size_t i = 0; i < n; i++) {
+      if (check_frame(&buf[cand[i]], size[i]) != SDS011_OK) {
+        size[i] = 0;
+      }
+    }
+
+    for (size_t i = 0; i < n && found < count; i++) {
+      if (size[i] == 0 || cand[i] < next) {
+        continue;
+      }
+      offsets[found++] = cand[i];
+      next = cand[i] + size[i];
+    }
+
+    if (found >= count) {
+      stop = next;
+      break;
+    }
+    if (incomplete < len) {
+      if (incomplete >= next) {
+        stop = incomplete;
+        break;
+      }
+      iter = next;
+    }
+  }
+
+  if (consumed != NULL) {
+    *consumed = stop;
+  }
+  return found;
+}
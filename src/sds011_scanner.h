@@ -0,0 +1,59 @@
+#ifndef SDS011_SCANNER_H__
+#define SDS011_SCANNER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sds011_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Find the first frame begin byte in the buffer.
+ *        The buffer is scanned 32 (AVX2) or 16 (SSE2) bytes at a time when
+ *        available, otherwise byte by byte.
+ * @param[in] buf data to be scanned
+ * @param[in] len size of the data
+ * @return offset of the first frame begin byte, len if not found
+ */
+size_t sds011_scanner_find(uint8_t const *buf, size_t len);
+
+/**
+ * @brief Check a single packet starting at the beginning of the buffer.
+ *        The checks are the same as the ones performed by
+ *        sds011_parser_parse: frame begin, command, CRC and frame end.
+ *        The payload is not decoded.
+ * @param[in] buf packet data
+ * @param[in] len size of the data
+ * @return SDS011_OK if the packet is valid, SDS011_ERR_MEM if the buffer
+ *         is too short to hold the packet, otherwise parser error code
+ */
+sds011_err_t sds011_scanner_check(uint8_t const *buf, size_t len);
+
+/**
+ * @brief Find valid packets in the buffer.
+ *        Frame begin candidates are collected in batches of 16, then the
+ *        checksum of every candidate is computed with one masked SAD over
+ *        its payload. Candidates start at arbitrary offsets, packing the
+ *        payloads of several candidates into one vector costs more than
+ *        it saves, see bench/bench_scanner.c. Packets do not overlap, scanning
+ *        continues after the end of every valid packet. Scanning stops at
+ *        the first candidate which does not fit in the buffer, so the
+ *        remaining bytes can be passed again together with more data.
+ * @param[in]  buf data to be scanned
+ * @param[in]  len size of the data
+ * @param[out] offsets offsets of the valid packets
+ * @param[in]  count maximum number of offsets
+ * @param[out] consumed number of processed bytes, can be NULL
+ * @return number of valid packets
+ */
+size_t sds011_scanner_scan(uint8_t const *buf, size_t len,
+                           size_t *offsets, size_t count, size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_SCANNER_H__
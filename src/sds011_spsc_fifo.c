@@ -0,0 +1,97 @@
+#include "sds011_spsc_fifo.h"
+
+static inline size_t increase(sds011_spsc_fifo_t const *fifo, size_t iter) {
+  return ++iter < fifo->count ? iter : 0;
+}
+
+static inline void* memloc(sds011_spsc_fifo_t const *fifo, size_t offset) {
+  return fifo->mem + (offset * fifo->elsize);
+}
+
+// Number of free slots seen by the producer
+static inline size_t free_slots(sds011_spsc_fifo_t const *fifo, size_t end, size_t beg) {
+  return beg > end ? beg - end - 1 : fifo->count - (end - beg) - 1;
+}
+
+// Number of used slots seen by the consumer
+static inline size_t used_slots(sds011_spsc_fifo_t const *fifo, size_t beg, size_t end) {
+  return end >= beg ? end - beg : fifo->count - (beg - end);
+}
+
+bool sds011_spsc_fifo_init(sds011_spsc_fifo_t *fifo, size_t elsize, void *mem, size_t size) {
+  if (fifo == NULL || mem == NULL) { return false; }
+  if (elsize == 0 || size == 0) { return false; }
+
+  fifo->elsize = elsize;
+
+  fifo->mem = mem;
+  fifo->size = size;
+  fifo->count = fifo->size / fifo->elsize;
+
+  atomic_init(&fifo->beg, 0);
+  atomic_init(&fifo->end, 0);
+  fifo->beg_cached = 0;
+  fifo->end_cached = 0;
+
+  return fifo->count > 0;
+}
+
+bool sds011_spsc_fifo_push(sds011_spsc_fifo_t *fifo, void const *el) {
+  if (fifo == NULL || el == NULL) { return false; }
+  return sds011_spsc_fifo_push_n(fifo, el, 1) == 1;
+}
+
+bool sds011_spsc_fifo_pop(sds011_spsc_fifo_t *fifo, void *el) {
+  if (fifo == NULL || el == NULL) { return false; }
+  return sds011_spsc_fifo_pop_n(fifo, el, 1) == 1;
+}
+
+size_t sds011_spsc_fifo_push_n(sds011_spsc_fifo_t *fifo, void const *els, size_t n) {
+  if (fifo == NULL || els == NULL) { return 0; }
+
+  size_t end = atomic_load_explicit(&fifo->end, memory_order_relaxed);
+
+  if (free_slots(fifo, end, fifo->beg_cached) < n) {
+    fifo->beg_cached = atomic_load_explicit(&fifo->beg, memory_order_acquire);
+  }
+
+  size_t slots = free_slots(fifo, end, fifo->beg_cached);
+  if (n > slots) {
+    n = slots;
+  }
+
+  uint8_t const *src = els;
+  for (size_t i = 0; i < n; i++) {
+    memcpy(memloc(fifo, end), src, fifo->elsize);
+    src += fifo->elsize;
+    end = increase(fifo, end);
+  }
+
+  atomic_store_explicit(&fifo->end, end, memory_order_release);
+  return n;
+}
+
+size_t sds011_spsc_fifo_pop_n(sds011_spsc_fifo_t *fifo, void *els, size_t n) {
+  if (fifo == NULL || els == NULL) { return 0; }
+
+  size_t beg = atomic_load_explicit(&fifo->beg, memory_order_relaxed);
+
+  if (used_slots(fifo, beg, fifo->end_cached) < n) {
+    fifo->end_cached = atomic_load_explicit(&fifo->end, memory_order_acquire);
+  }
+
+  size_t slots = used_slots(fifo, beg, fifo->end_cached);
+  if (n > slots) {
+    n = slots;
+  }
+
+  uint8_t *dst = els;
+  for (size_t i = 0; i < n; i++) {
+    memcpy(dst, memloc(fifo, beg), fifo->elsize);
+    dst += fifo->elsize;
+    beg = increase(fifo, beg);
+  }
+
+  atomic_store_explicit(&fifo->beg, beg, memory_order_release);
+  return n;
+}
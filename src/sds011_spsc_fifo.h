@@ -0,0 +1,85 @@
+#ifndef SDS011_SPSC_FIFO_H__
+#define SDS011_SPSC_FIFO_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+#include "sds011_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-free single producer, single consumer variant of sds011_fifo_t.
+ * One thread (or interrupt handler) may push while another one pops,
+ * without a mutex. The indices are kept in separate cache lines, each side
+ * caches the index of the other side and reloads it only when the fifo
+ * looks full or empty.
+ */
+typedef struct {
+  uint8_t *mem;
+  size_t size;
+  size_t elsize;
+  size_t count;
+
+  alignas(SDS011_CACHE_LINE_SIZE) atomic_size_t end; // written by producer
+  size_t beg_cached;
+
+  alignas(SDS011_CACHE_LINE_SIZE) atomic_size_t beg; // written by consumer
+  size_t end_cached;
+} sds011_spsc_fifo_t;
+
+/**
+ * Initialize fifo, not thread safe.
+ * @param[in] fifo fifo structure
+ * @param[in] elsize size of a single element
+ * @param[in] mem memory for the elements, one element is kept unused
+ * @param[in] size size of the memory
+ * @return true on success, otherwise false
+ */
+bool sds011_spsc_fifo_init(sds011_spsc_fifo_t *fifo, size_t elsize, void *mem, size_t size);
+
+/**
+ * Push element, may be called by the producer only
+ * @param[in] fifo fifo structure
+ * @param[in] el element
+ * @return true on success, false if the fifo is full
+ */
+bool sds011_spsc_fifo_push(sds011_spsc_fifo_t *fifo, void const *el);
+
+/**
+ * Pop element, may be called by the consumer only
+ * @param[in]  fifo fifo structure
+ * @param[out] el element
+ * @return true on success, false if the fifo is empty
+ */
+bool sds011_spsc_fifo_pop(sds011_spsc_fifo_t *fifo, void *el);
+
+/**
+ * Push up to n elements, may be called by the producer only. The elements
+ * are published at once.
+ * @param[in] fifo fifo structure
+ * @param[in] els elements
+ * @param[in] n number of elements
+ * @return number of pushed elements
+ */
+size_t sds011_spsc_fifo_push_n(sds011_spsc_fifo_t *fifo, void const *els, size_t n);
+
+/**
+ * Pop up to n elements, may be called by the consumer only
+ * @param[in]  fifo fifo structure
+ * @param[out] els elements
+ * @param[in]  n maximum number of elements
+ * @return number of popped elements
+ */
+size_t sds011_spsc_fifo_pop_n(sds011_spsc_fifo_t *fifo, void *els, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_SPSC_FIFO_H__
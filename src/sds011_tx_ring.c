@@ -0,0 +1,117 @@
+#include "sds011_tx_ring.h"
+
+#include <string.h>
+
+static inline size_t slot(sds011_tx_ring_t const *ring, size_t offset) {
+  size_t iter = ring->beg + offset;
+  return iter < SDS011_TX_RING_SIZE ? iter : iter - SDS011_TX_RING_SIZE;
+}
+
+void sds011_tx_ring_init(sds011_tx_ring_t *ring) {
+  if (ring == NULL) { return; }
+  ring->beg = 0;
+  ring->count = 0;
+  ring->pushed = 0;
+}
+
+bool sds011_tx_ring_push(sds011_tx_ring_t *ring, uint8_t const *buf, size_t size) {
+  if (buf == NULL || size == 0) { return false; }
+  if (size > SDS011_QUERY_PACKET_SIZE) { return false; }
+
+  uint8_t *frame = sds011_tx_ring_reserve(ring);
+  if (frame == NULL) {
+    return false;
+  }
+  memcpy(frame, buf, size);
+  return sds011_tx_ring_commit(ring, size);
+}
+
+uint8_t *sds011_tx_ring_reserve(sds011_tx_ring_t *ring) {
+  if (ring == NULL) { return NULL; }
+
+  if (ring->count == SDS011_TX_RING_SIZE) {
+    return NULL;
+  }
+  return ring->frames[slot(ring, ring->count)];
+}
+
+bool sds011_tx_ring_commit(sds011_tx_ring_t *ring, size_t size) {
+  if (ring == NULL || size == 0) { return false; }
+  if (size > SDS011_QUERY_PACKET_SIZE) { return false; }
+
+  if (ring->count == SDS011_TX_RING_SIZE) {
+    return false;
+  }
+
+  size_t iter = slot(ring, ring->count);
+  sds011_iovec_t *iov = &ring->iov[iter];
+  iov->iov_base = ring->frames[iter];
+  iov->iov_len  = size;
+
+  ring->count++;
+  ring->pushed++;
+  return true;
+}
+
+uint32_t sds011_tx_ring_last(sds011_tx_ring_t const *ring) {
+  return ring == NULL ? 0 : ring->pushed;
+}
+
+// Frames are sent in push order, the frame was sent if it is older than
+// the pending ones. The difference is taken modulo 2^32, the number wraps.
+bool sds011_tx_ring_is_sent(sds011_tx_ring_t const *ring, uint32_t seq) {
+  if (ring == NULL) { return true; }
+  uint32_t sent = ring->pushed - (uint32_t)ring->count;
+  return (uint32_t)(sent - seq) < UINT32_C(0x80000000);
+}
+
+size_t sds011_tx_ring_peek(sds011_tx_ring_t const *ring, sds011_iovec_t const **iov) {
+  if (ring == NULL || iov == NULL) { return 0; }
+
+  *iov = &ring->iov[ring->beg];
+
+  size_t run = SDS011_TX_RING_SIZE - ring->beg;
+  return ring->count < run ? ring->count : run;
+}
+
+void sds011_tx_ring_consume(sds011_tx_ring_t *ring, size_t bytes) {
+  if (ring == NULL) { return; }
+
+  while (bytes > 0 && ring->count > 0) {
+    sds011_iovec_t *iov = &ring->iov[ring->beg];
+
+    if (bytes < iov->iov_len) {
+      iov->iov_base = (uint8_t *)iov->iov_base + bytes;
+      iov->iov_len -= bytes;
+      return;
+    }
+
+    bytes -= iov->iov_len;
+    ring->beg = slot(ring, 1);
+    ring->count--;
+  }
+}
+
+bool sds011_tx_ring_is_empty(sds011_tx_ring_t const *ring) {
+  return ring == NULL || ring->count == 0;
+}
+
+#ifdef SDS011_TX_RING_POSIX
+// The pending slots are gathered in order, the wrapped run after the run
+// up to the end of the ring, so they take one writev call.
+ssize_t sds011_tx_ring_writev(sds011_tx_ring_t *ring, int fd) {
+  if (ring == NULL) { return -1; }
+  if (ring->count == 0) { return 0; }
+
+  sds011_iovec_t iov[SDS011_TX_RING_SIZE];
+  for (size_t i = 0; i < ring->count; i++) {
+    iov[i] = ring->iov[slot(ring, i)];
+  }
+
+  ssize_t res = writev(fd, iov, (int)ring->count);
+  if (res > 0) {
+    sds011_tx_ring_consume(ring, (size_t)res);
+  }
+  return res;
+}
+#endif
@@ -0,0 +1,138 @@
+#ifndef SDS011_TX_RING_H__
+#define SDS011_TX_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sds011_config.h"
+#include "sds011_common.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/uio.h>
+#define SDS011_TX_RING_POSIX 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SDS011_TX_RING_POSIX
+typedef struct iovec sds011_iovec_t;
+#else
+typedef struct {
+  void *iov_base;
+  size_t iov_len;
+} sds011_iovec_t;
+#endif
+
+/**
+ * Ring of frames waiting for transmission. Frames are copied into the
+ * slots, so the sender may reuse its buffer as soon as the frame is
+ * queued. On POSIX systems the slots are described by struct iovec, so
+ * pending frames, also those queued by several sensor instances sharing
+ * one serial port, can be written with a single writev call. Frames are
+ * numbered in push order, with the number the sender can check whether
+ * its frame was transmitted.
+ */
+typedef struct {
+  sds011_iovec_t iov[SDS011_TX_RING_SIZE];
+  uint8_t frames[SDS011_TX_RING_SIZE][SDS011_QUERY_PACKET_SIZE];
+  size_t beg;
+  size_t count;
+  uint32_t pushed; // number of the last pushed frame
+} sds011_tx_ring_t;
+
+/**
+ * Initialize transmit ring
+ * @param[in] ring transmit ring structure
+ */
+void sds011_tx_ring_init(sds011_tx_ring_t *ring);
+
+/**
+ * Queue copy of the frame for transmission
+ * @param[in] ring transmit ring structure
+ * @param[in] buf frame
+ * @param[in] size size of the frame, up to SDS011_QUERY_PACKET_SIZE
+ * @return true on success, false if the ring is full or the frame too long
+ */
+bool sds011_tx_ring_push(sds011_tx_ring_t *ring, uint8_t const *buf, size_t size);
+
+/**
+ * @brief Get slot for the next frame.
+ *        The frame is written straight into the slot, of
+ *        SDS011_QUERY_PACKET_SIZE bytes, and queued by
+ *        sds011_tx_ring_commit.
+ * @param[in] ring transmit ring structure
+ * @return slot buffer or NULL if the ring is full
+ */
+uint8_t *sds011_tx_ring_reserve(sds011_tx_ring_t *ring);
+
+/**
+ * Queue frame written to the slot returned by sds011_tx_ring_reserve
+ * @param[in] ring transmit ring structure
+ * @param[in] size size of the frame, up to SDS011_QUERY_PACKET_SIZE
+ * @return true on success, false if the ring is full or the frame too long
+ */
+bool sds011_tx_ring_commit(sds011_tx_ring_t *ring, size_t size);
+
+/**
+ * Get number of the last pushed frame
+ * @param[in] ring transmit ring structure
+ * @return frame number, wraps around
+ */
+uint32_t sds011_tx_ring_last(sds011_tx_ring_t const *ring);
+
+/**
+ * Check if the frame was transmitted, i.e. all its bytes were consumed
+ * @param[in] ring transmit ring structure
+ * @param[in] seq frame number returned by sds011_tx_ring_last after the push
+ * @return true if the frame is not pending anymore
+ */
+bool sds011_tx_ring_is_sent(sds011_tx_ring_t const *ring, uint32_t seq);
+
+/**
+ * @brief Get pending slots.
+ *        Only slots stored contiguously are returned, call again after
+ *        sds011_tx_ring_consume to get the slots wrapped around the end of
+ *        the ring.
+ * @param[in]  ring transmit ring structure
+ * @param[out] iov first pending slot
+ * @return number of contiguous pending slots
+ */
+size_t sds011_tx_ring_peek(sds011_tx_ring_t const *ring, sds011_iovec_t const **iov);
+
+/**
+ * Consume transmitted bytes. Partially transmitted frames stay in the ring
+ * with the remaining bytes.
+ * @param[in] ring transmit ring structure
+ * @param[in] bytes number of transmitted bytes
+ */
+void sds011_tx_ring_consume(sds011_tx_ring_t *ring, size_t bytes);
+
+/**
+ * Check if there are pending frames
+ * @param[in] ring transmit ring structure
+ * @return true if no frames are pending
+ */
+bool sds011_tx_ring_is_empty(sds011_tx_ring_t const *ring);
+
+#ifdef SDS011_TX_RING_POSIX
+/**
+ * @brief Write pending frames to file descriptor.
+ *        All pending frames are written with a single writev call, also
+ *        when they wrap around the end of the ring. Transmitted bytes are
+ *        consumed.
+ * @param[in] ring transmit ring structure
+ * @param[in] fd file descriptor, e.g. serial port
+ * @return number of written bytes, -1 on error (see errno)
+ */
+ssize_t sds011_tx_ring_writev(sds011_tx_ring_t *ring, int fd);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_TX_RING_H__
@@ -3,6 +3,7 @@
 #include <stddef.h>
 #include <setjmp.h>
 #include <cmocka.h>
+#include <string.h>
 
 #include "../src/sds011_builder.h"
 
@@ -483,6 +484,139 @@ static void test_builder_invalid_src(void **state) {
   assert_int_equal(sds011_builder_get_error(), SDS011_ERR_INVALID_SRC);
 }
 
+static void test_builder_build_r(void **state) {
+  (void) state; /* unused */
+
+  uint8_t buffer[19];
+  sds011_err_t err = SDS011_ERR_BUSY;
+  sds011_msg_t msg = {
+    .dev_id = 0xA160,
+    .type   = SDS011_MSG_TYPE_DATA,
+    .op     = SDS011_MSG_OP_GET,
+    .src    = SDS011_MSG_SRC_HOST,
+  };
+
+  // the latest error of the non-reentrant version is kept
+  assert_int_equal(sds011_builder_build(NULL, buffer, sizeof(buffer)), 0);
+  assert_int_equal(sds011_builder_get_error(), SDS011_ERR_INVALID_PARAM);
+
+  assert_int_equal(sds011_builder_build_r(&msg, buffer, sizeof(buffer), &err), 19);
+  assert_int_equal(err, SDS011_OK);
+  assert_int_equal(sds011_builder_build_r(&msg, buffer, 18, &err), 0);
+  assert_int_equal(err, SDS011_ERR_MEM);
+  assert_int_equal(sds011_builder_build_r(NULL, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_builder_build_r(&msg, buffer, sizeof(buffer), NULL), 19);
+
+  msg.src = (sds011_msg_src_t)2;
+  assert_int_equal(sds011_builder_build_r(&msg, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_SRC);
+  msg.src = SDS011_MSG_SRC_HOST;
+  msg.type = (sds011_msg_type_t)3;
+  assert_int_equal(sds011_builder_build_r(&msg, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_MSG_TYPE);
+
+  assert_int_equal(sds011_builder_get_error(), SDS011_ERR_INVALID_PARAM);
+}
+
+static void test_builder_build_many(void **state) {
+  (void) state; /* unused */
+
+  sds011_msg_t msgs[] = {
+    { .dev_id = 0xA160, .type = SDS011_MSG_TYPE_DATA,  .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.sleep = SDS011_SLEEP_OFF },
+    { .dev_id = 0xA162, .type = (sds011_msg_type_t)3,  .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST },
+    { .dev_id = 0xA163, .type = SDS011_MSG_TYPE_DATA,  .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST },
+    { .dev_id = 0xA164, .type = SDS011_MSG_TYPE_DATA,  .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST },
+  };
+  sds011_builder_frame_t frames[5];
+  uint8_t buffer[60];
+  uint8_t ref[SDS011_QUERY_PACKET_SIZE];
+
+  memset(buffer, 0x55, sizeof(buffer));
+
+  // the last message does not fit
+  assert_int_equal(sds011_builder_build_many(msgs, 5, buffer, 50, frames), 48);
+
+  size_t const offsets[] = { 0, 19, 29, 29, 48 };
+  size_t const sizes[]   = { 19, 10, 0, 19, 0 };
+  sds011_err_t const errors[] = {
+    SDS011_OK, SDS011_OK, SDS011_ERR_INVALID_MSG_TYPE, SDS011_OK, SDS011_ERR_MEM
+  };
+  for (size_t i = 0; i < 5; i++) {
+    assert_int_equal(frames[i].offset, offsets[i]);
+    assert_int_equal(frames[i].size,   sizes[i]);
+    assert_int_equal(frames[i].error,  errors[i]);
+    if (frames[i].size > 0) {
+      assert_int_equal(sds011_builder_build(&msgs[i], ref, sizeof(ref)), sizes[i]);
+      assert_memory_equal(&buffer[offsets[i]], ref, sizes[i]);
+    }
+  }
+  assert_int_equal(buffer[50], 0x55);
+
+  // invalid params
+  assert_int_equal(sds011_builder_build_many(NULL, 5, buffer, 50, frames), 0);
+  assert_int_equal(sds011_builder_build_many(msgs, 5, NULL,   50, frames), 0);
+  assert_int_equal(sds011_builder_build_many(msgs, 5, buffer, 50, NULL), 0);
+  assert_int_equal(sds011_builder_build_many(msgs, 0, buffer, 50, frames), 0);
+}
+
+static void test_builder_build_fleet(void **state) {
+  (void) state; /* unused */
+
+  uint16_t const dev_ids[] = { 0x0000, 0xA160, 0xFFFF, 0x01FE, 0xFE01 };
+  uint8_t buffer[5 * SDS011_QUERY_PACKET_SIZE];
+  uint8_t ref[SDS011_QUERY_PACKET_SIZE];
+  sds011_err_t err;
+
+  sds011_msg_t msg = {
+    .dev_id = 0x1234,
+    .type   = SDS011_MSG_TYPE_OP_MODE,
+    .op     = SDS011_MSG_OP_SET,
+    .src    = SDS011_MSG_SRC_HOST,
+    .data.op_mode = { SDS011_OP_MODE_INTERVAL, 5 },
+  };
+
+  // queries
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 5, buffer, sizeof(buffer), &err),
+    sizeof(buffer));
+  assert_int_equal(err, SDS011_OK);
+  for (size_t i = 0; i < 5; i++) {
+    msg.dev_id = dev_ids[i];
+    assert_int_equal(sds011_builder_build(&msg, ref, sizeof(ref)), SDS011_QUERY_PACKET_SIZE);
+    assert_memory_equal(&buffer[i * SDS011_QUERY_PACKET_SIZE], ref, SDS011_QUERY_PACKET_SIZE);
+  }
+
+  // replies
+  msg.src = SDS011_MSG_SRC_SENSOR;
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 5, buffer, sizeof(buffer), &err),
+    5 * SDS011_REPLY_PACKET_SIZE);
+  for (size_t i = 0; i < 5; i++) {
+    msg.dev_id = dev_ids[i];
+    assert_int_equal(sds011_builder_build(&msg, ref, sizeof(ref)), SDS011_REPLY_PACKET_SIZE);
+    assert_memory_equal(&buffer[i * SDS011_REPLY_PACKET_SIZE], ref, SDS011_REPLY_PACKET_SIZE);
+  }
+
+  // errors
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 0, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_OK);
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 5, buffer, 49, &err), 0);
+  assert_int_equal(err, SDS011_ERR_MEM);
+  assert_int_equal(sds011_builder_build_fleet(&msg, NULL, 5, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 5, NULL, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_builder_build_fleet(NULL, dev_ids, 5, buffer, sizeof(buffer), &err), 0);
+  assert_int_equal(err, SDS011_ERR_INVALID_PARAM);
+  msg.type = (sds011_msg_type_t)3;
+  assert_int_equal(sds011_builder_build_fleet(&msg, dev_ids, 5, buffer, sizeof(buffer), NULL), 0);
+}
+
 int main(void) {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_builder_params),
@@ -500,6 +634,9 @@ int main(void) {
     cmocka_unit_test(test_builder_missing),
     cmocka_unit_test(test_builder_invalid_type),
     cmocka_unit_test(test_builder_invalid_src),
+    cmocka_unit_test(test_builder_build_r),
+    cmocka_unit_test(test_builder_build_many),
+    cmocka_unit_test(test_builder_build_fleet),
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
 }
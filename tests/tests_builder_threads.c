@@ -0,0 +1,84 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../src/sds011_builder.h"
+
+#define THREADS     8
+#define ITERATIONS  20000
+
+typedef struct {
+  uint16_t id;
+  size_t failures;
+} worker_t;
+
+// Every thread builds valid and invalid messages, the error of every call
+// has to match the message regardless of the other threads.
+static void *worker(void *arg) {
+  worker_t *w = arg;
+  uint8_t buffer[SDS011_QUERY_PACKET_SIZE];
+  uint8_t ref[SDS011_QUERY_PACKET_SIZE];
+
+  sds011_msg_t valid = {
+    .dev_id = w->id,
+    .type   = SDS011_MSG_TYPE_SLEEP,
+    .op     = SDS011_MSG_OP_SET,
+    .src    = SDS011_MSG_SRC_HOST,
+    .data.sleep = SDS011_SLEEP_ON,
+  };
+  sds011_msg_t invalid = valid;
+  invalid.type = (sds011_msg_type_t)(w->id % 2 ? 1 : 3);
+
+  if (sds011_builder_build_r(&valid, ref, sizeof(ref), NULL) != SDS011_QUERY_PACKET_SIZE) {
+    w->failures++;
+  }
+
+  for (int i = 0; i < ITERATIONS; i++) {
+    sds011_err_t err;
+    size_t bytes;
+
+    bytes = sds011_builder_build_r(&valid, buffer, sizeof(buffer), &err);
+    if (bytes != SDS011_QUERY_PACKET_SIZE || err != SDS011_OK ||
+        memcmp(buffer, ref, sizeof(ref)) != 0) {
+      w->failures++;
+    }
+
+    bytes = sds011_builder_build_r(&invalid, buffer, sizeof(buffer), &err);
+    if (bytes != 0 || err != SDS011_ERR_INVALID_MSG_TYPE) {
+      w->failures++;
+    }
+
+    bytes = sds011_builder_build_r(&valid, buffer, sizeof(buffer) - 1 - (size_t)(i % 4), &err);
+    if (bytes != 0 || err != SDS011_ERR_MEM) {
+      w->failures++;
+    }
+  }
+  return NULL;
+}
+
+static void test_build_r_threads(void **state) {
+  (void)state;
+
+  pthread_t threads[THREADS];
+  worker_t workers[THREADS];
+
+  for (int i = 0; i < THREADS; i++) {
+    workers[i] = (worker_t) { .id = (uint16_t)(0xA000 + i), .failures = 0 };
+    assert_int_equal(pthread_create(&threads[i], NULL, worker, &workers[i]), 0);
+  }
+  for (int i = 0; i < THREADS; i++) {
+    assert_int_equal(pthread_join(threads[i], NULL), 0);
+    assert_int_equal(workers[i].failures, 0);
+  }
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_build_r_threads),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,174 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../tools/sds011_capture.h"
+#include "../src/sds011_builder.h"
+
+#define CAPTURE_SIZE (512 * 1024)
+
+static uint8_t *_capture;
+static size_t _capture_len;
+static size_t _capture_samples;
+
+// Data replies from 16 devices mixed with queries and random noise
+static int setup(void **state) {
+  (void)state;
+
+  _capture = malloc(CAPTURE_SIZE);
+  _capture_len = 0;
+  _capture_samples = 0;
+
+  uint32_t seed = 7;
+  while (_capture_len + SDS011_QUERY_PACKET_SIZE + 1 <= CAPTURE_SIZE) {
+    seed = seed * 1103515245 + 12345;
+
+    sds011_msg_t msg = {
+      .dev_id             = (uint16_t)(0xA000 + ((seed >> 8) & 0x0F)),
+      .type               = SDS011_MSG_TYPE_DATA,
+      .op                 = SDS011_MSG_OP_GET,
+      .src                = SDS011_MSG_SRC_SENSOR,
+      .data.sample.pm2_5  = (uint16_t)(seed >> 16),
+      .data.sample.pm10   = (uint16_t)(seed >> 12),
+    };
+    if ((seed >> 24) % 5 == 0) {
+      msg.src = SDS011_MSG_SRC_HOST;
+    } else {
+      _capture_samples++;
+    }
+    _capture_len += sds011_builder_build(
+      &msg, &_capture[_capture_len], CAPTURE_SIZE - _capture_len);
+
+    if ((seed >> 20) % 7 == 0) {
+      _capture[_capture_len++] = (uint8_t)(seed >> 4);
+    }
+  }
+  return 0;
+}
+
+static int teardown(void **state) {
+  (void)state;
+  free(_capture);
+  return 0;
+}
+
+static void assert_samples_equal(sds011_capture_t const *a, sds011_capture_t const *b) {
+  assert_int_equal(a->count, b->count);
+  for (size_t i = 0; i < a->count; i++) {
+    assert_int_equal(a->samples[i].offset,       b->samples[i].offset);
+    assert_int_equal(a->samples[i].dev_id,       b->samples[i].dev_id);
+    assert_int_equal(a->samples[i].sample.pm2_5, b->samples[i].sample.pm2_5);
+    assert_int_equal(a->samples[i].sample.pm10,  b->samples[i].sample.pm10);
+  }
+}
+
+static void test_capture_params(void **state) {
+  (void)state;
+
+  sds011_capture_t capture;
+
+  assert_int_equal(sds011_capture_parse(NULL, 10, 1, &capture), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_capture_parse(_capture, 10, 1, NULL), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_capture_parse(NULL, 0, 1, &capture), SDS011_OK);
+  assert_int_equal(capture.count, 0);
+  assert_int_equal(sds011_capture_parse_file("/nonexistent", 1, &capture), SDS011_ERR_INVALID_PARAM);
+}
+
+static void test_capture_threads(void **state) {
+  (void)state;
+
+  sds011_capture_t ref, capture;
+
+  assert_int_equal(sds011_capture_parse(_capture, _capture_len, 1, &ref), SDS011_OK);
+  assert_true(ref.count > 0);
+  assert_true(ref.count <= _capture_samples);
+  assert_true(ref.count > _capture_samples * 99 / 100);
+
+  for (unsigned threads = 2; threads <= 8; threads++) {
+    assert_int_equal(sds011_capture_parse(_capture, _capture_len, threads, &capture), SDS011_OK);
+    assert_samples_equal(&capture, &ref);
+    sds011_capture_free(&capture);
+  }
+
+  for (size_t i = 1; i < ref.count; i++) {
+    assert_true(ref.samples[i - 1].offset < ref.samples[i].offset);
+  }
+  sds011_capture_free(&ref);
+}
+
+static void test_capture_nested_offset(void **state) {
+  (void)state;
+
+  uint8_t const reply[] = { 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB };
+  uint8_t buf[SDS011_REPLY_PACKET_SIZE + SDS011_QUERY_PACKET_SIZE] = { 0 };
+  size_t len = 0;
+
+  // valid reply, then a reply within a query dropped on its crc byte
+  memcpy(&buf[len], reply, sizeof(reply));
+  len += sizeof(reply);
+  buf[len++] = SDS011_FRAME_BEG;
+  buf[len++] = SDS011_CMD_QUERY;
+  memcpy(&buf[len], reply, sizeof(reply));
+  len += SDS011_QUERY_DATA_SIZE;
+  buf[len++] = 0x01;
+  buf[len++] = SDS011_FRAME_END;
+
+  sds011_capture_t capture;
+  assert_int_equal(sds011_capture_parse(buf, len, 1, &capture), SDS011_OK);
+  assert_int_equal(capture.count, 2);
+  assert_int_equal(capture.samples[0].offset, 0);
+  assert_int_equal(capture.samples[1].offset, SDS011_REPLY_PACKET_SIZE + 2);
+  sds011_capture_free(&capture);
+}
+
+static void test_capture_sort_by_device(void **state) {
+  (void)state;
+
+  sds011_capture_t capture;
+
+  assert_int_equal(sds011_capture_parse(_capture, _capture_len, 4, &capture), SDS011_OK);
+  sds011_capture_sort_by_device(&capture);
+
+  for (size_t i = 1; i < capture.count; i++) {
+    sds011_capture_sample_t const *a = &capture.samples[i - 1];
+    sds011_capture_sample_t const *b = &capture.samples[i];
+    assert_true(a->dev_id < b->dev_id || (a->dev_id == b->dev_id && a->offset < b->offset));
+  }
+  sds011_capture_free(&capture);
+}
+
+static void test_capture_file(void **state) {
+  (void)state;
+
+  char path[] = "/tmp/sds011_capture_XXXXXX";
+  int fd = mkstemp(path);
+  assert_true(fd >= 0);
+
+  FILE *file = fdopen(fd, "wb");
+  assert_int_equal(fwrite(_capture, 1, _capture_len, file), _capture_len);
+  fclose(file);
+
+  sds011_capture_t ref, capture;
+  assert_int_equal(sds011_capture_parse(_capture, _capture_len, 1, &ref), SDS011_OK);
+  assert_int_equal(sds011_capture_parse_file(path, 0, &capture), SDS011_OK);
+  assert_samples_equal(&capture, &ref);
+
+  sds011_capture_free(&capture);
+  sds011_capture_free(&ref);
+  remove(path);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_capture_params),
+    cmocka_unit_test(test_capture_threads),
+    cmocka_unit_test(test_capture_nested_offset),
+    cmocka_unit_test(test_capture_sort_by_device),
+    cmocka_unit_test(test_capture_file),
+  };
+  return cmocka_run_group_tests(tests, setup, teardown);
+}
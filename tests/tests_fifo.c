@@ -147,6 +147,74 @@ static void test_circular_buffer(void **state) {
   assert_int_equal(v1, v2);
 }
 
+static void test_reserve_commit(void **state) {
+  (void) state;
+
+  sds011_fifo_t f, *fifo = &f;
+  uint16_t mem[3];
+  uint16_t v;
+
+  assert_true(sds011_fifo_init(fifo, sizeof(uint16_t), mem, sizeof(mem)));
+
+  assert_null(sds011_fifo_reserve(NULL));
+  assert_false(sds011_fifo_commit(NULL));
+
+  // reserved slot is not added without commit
+  uint16_t *slot = sds011_fifo_reserve(fifo);
+  assert_true(slot == &mem[0]);
+  *slot = 0x1234;
+  assert_false(sds011_fifo_pop(fifo, &v));
+  assert_true(sds011_fifo_commit(fifo));
+
+  slot = sds011_fifo_reserve(fifo);
+  assert_true(slot == &mem[1]);
+  *slot = 0x5678;
+  assert_true(sds011_fifo_commit(fifo));
+
+  // full
+  assert_null(sds011_fifo_reserve(fifo));
+  assert_false(sds011_fifo_commit(fifo));
+
+  assert_true(sds011_fifo_pop(fifo, &v));
+  assert_int_equal(v, 0x1234);
+  assert_true(sds011_fifo_pop(fifo, &v));
+  assert_int_equal(v, 0x5678);
+}
+
+static void test_peek_release(void **state) {
+  (void) state;
+
+  sds011_fifo_t f, *fifo = &f;
+  uint16_t mem[3];
+  uint16_t v;
+
+  assert_true(sds011_fifo_init(fifo, sizeof(uint16_t), mem, sizeof(mem)));
+
+  assert_null(sds011_fifo_peek(NULL));
+  assert_false(sds011_fifo_release(NULL));
+  assert_null(sds011_fifo_peek(fifo));
+  assert_false(sds011_fifo_release(fifo));
+
+  for (uint16_t round = 0; round < 4; round++) {
+    v = round;
+    assert_true(sds011_fifo_push(fifo, &v));
+    v = round + 100;
+    assert_true(sds011_fifo_push(fifo, &v));
+
+    // element is not copied and stays until released
+    uint16_t *el = sds011_fifo_peek(fifo);
+    assert_true(el >= &mem[0] && el <= &mem[2]);
+    assert_int_equal(*el, round);
+    assert_true(sds011_fifo_peek(fifo) == el);
+    assert_true(sds011_fifo_release(fifo));
+
+    el = sds011_fifo_peek(fifo);
+    assert_int_equal(*el, round + 100);
+    assert_true(sds011_fifo_release(fifo));
+    assert_null(sds011_fifo_peek(fifo));
+  }
+}
+
 int main(void) {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_init_no_segfault),
@@ -158,6 +226,8 @@ int main(void) {
     cmocka_unit_test(test_push_but_full),
     cmocka_unit_test(test_push_pop),
     cmocka_unit_test(test_circular_buffer),
+    cmocka_unit_test(test_reserve_commit),
+    cmocka_unit_test(test_peek_release),
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
 }
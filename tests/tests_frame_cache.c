@@ -0,0 +1,171 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+
+#include "../src/sds011_frame_cache.h"
+#include "../src/sds011_builder.h"
+
+static sds011_frame_cache_t cache;
+
+static void assert_frame_built(sds011_msg_t const *msg, uint8_t const *frame, size_t size) {
+  uint8_t ref[SDS011_QUERY_PACKET_SIZE];
+  assert_int_equal(sds011_builder_build(msg, ref, sizeof(ref)), size);
+  assert_memory_equal(frame, ref, size);
+}
+
+static void test_cache_hit(void **state) {
+  (void)state;
+
+  sds011_msg_t msg = {
+    .dev_id = 0xA160,
+    .type   = SDS011_MSG_TYPE_DATA,
+    .op     = SDS011_MSG_OP_GET,
+    .src    = SDS011_MSG_SRC_HOST,
+  };
+  uint8_t const *frame1;
+  uint8_t const *frame2;
+  size_t size;
+
+  sds011_frame_cache_init(&cache);
+
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame1, &size), SDS011_OK);
+  assert_int_equal(size, SDS011_QUERY_PACKET_SIZE);
+  assert_frame_built(&msg, frame1, size);
+
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame2, &size), SDS011_OK);
+  assert_true(frame1 == frame2);
+  assert_frame_built(&msg, frame2, size);
+
+  assert_int_equal(sds011_frame_cache_get(NULL, &msg, &frame2, &size), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_frame_cache_get(&cache, NULL, &frame2, &size), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, NULL, &size), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame2, NULL), SDS011_ERR_INVALID_PARAM);
+}
+
+static void test_cache_keys(void **state) {
+  (void)state;
+
+  // every message differs from the previous one in a single field
+  sds011_msg_t const msgs[] = {
+    { .dev_id = 0xA160, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.sleep = SDS011_SLEEP_ON },
+    { .dev_id = 0xA160, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.sleep = SDS011_SLEEP_OFF },
+    { .dev_id = 0xA160, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST, .data.sleep = SDS011_SLEEP_OFF },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_HOST, .data.sleep = SDS011_SLEEP_OFF },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_SLEEP, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.sleep = SDS011_SLEEP_OFF },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_REP_MODE, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.rep_mode = SDS011_REP_MODE_QUERY },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_DEV_ID, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.new_dev_id = 0xA001 },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_DEV_ID, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.new_dev_id = 0xA002 },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_OP_MODE, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.op_mode = { SDS011_OP_MODE_INTERVAL, 5 } },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_OP_MODE, .op = SDS011_MSG_OP_SET,
+      .src = SDS011_MSG_SRC_HOST, .data.op_mode = { SDS011_OP_MODE_CONTINOUS, 5 } },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_FW_VER, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.fw_ver = { 18, 11, 16 } },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_FW_VER, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.fw_ver = { 18, 11, 17 } },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_DATA, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.sample = { 1236, 2618 } },
+    { .dev_id = 0xA161, .type = SDS011_MSG_TYPE_DATA, .op = SDS011_MSG_OP_GET,
+      .src = SDS011_MSG_SRC_SENSOR, .data.sample = { 1236, 2619 } },
+  };
+  size_t const count = sizeof(msgs) / sizeof(msgs[0]);
+
+  sds011_frame_cache_init(&cache);
+
+  // twice, the second pass mixes hits and rebuilds of evicted entries
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < count; i++) {
+      uint8_t const *frame;
+      size_t size;
+      assert_int_equal(sds011_frame_cache_get(&cache, &msgs[i], &frame, &size), SDS011_OK);
+      assert_frame_built(&msgs[i], frame, size);
+    }
+  }
+}
+
+static void test_cache_eviction(void **state) {
+  (void)state;
+
+  uint8_t const *frame;
+  size_t size;
+
+  sds011_frame_cache_init(&cache);
+
+  // more devices than entries
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint16_t dev_id = 0; dev_id < 4 * SDS011_FRAME_CACHE_SIZE; dev_id++) {
+      sds011_msg_t msg = {
+        .dev_id = dev_id,
+        .type   = SDS011_MSG_TYPE_DATA,
+        .op     = SDS011_MSG_OP_GET,
+        .src    = SDS011_MSG_SRC_HOST,
+      };
+      assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size), SDS011_OK);
+      assert_frame_built(&msg, frame, size);
+    }
+  }
+}
+
+static void test_cache_invalid_msg(void **state) {
+  (void)state;
+
+  uint8_t const *frame;
+  size_t size;
+  sds011_msg_t msg = {
+    .dev_id = 0xA160,
+    .type   = SDS011_MSG_TYPE_DATA,
+    .op     = SDS011_MSG_OP_GET,
+    .src    = SDS011_MSG_SRC_HOST,
+  };
+
+  sds011_frame_cache_init(&cache);
+
+  msg.type = (sds011_msg_type_t)(SDS011_MSG_TYPE_DATA + 256);
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size),
+    SDS011_ERR_INVALID_MSG_TYPE);
+
+  msg.type = (sds011_msg_type_t)3;
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size),
+    SDS011_ERR_INVALID_MSG_TYPE);
+
+  msg.type = SDS011_MSG_TYPE_DATA;
+  msg.src = (sds011_msg_src_t)2;
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size),
+    SDS011_ERR_INVALID_SRC);
+
+  // fields the key cannot hold are built without the cache, the same way
+  // as by the builder
+  uint8_t const *cached;
+  msg.src = SDS011_MSG_SRC_HOST;
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &cached, &size), SDS011_OK);
+
+  msg.op = (sds011_msg_op_t)2;
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size), SDS011_OK);
+  assert_frame_built(&msg, frame, size);
+  assert_true(frame != cached);
+
+  msg.op = SDS011_MSG_OP_GET;
+  assert_int_equal(sds011_frame_cache_get(&cache, &msg, &frame, &size), SDS011_OK);
+  assert_true(frame == cached);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_cache_hit),
+    cmocka_unit_test(test_cache_keys),
+    cmocka_unit_test(test_cache_eviction),
+    cmocka_unit_test(test_cache_invalid_msg),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
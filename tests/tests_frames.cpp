@@ -0,0 +1,84 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../src/sds011_frames.hpp"
+#include "../src/sds011_builder.h"
+
+namespace frames = sds011::frames;
+
+// evaluated by the compiler
+static constexpr frames::frame_t _query_data = frames::query_data();
+static_assert(_query_data[0]  == SDS011_FRAME_BEG, "frame begin");
+static_assert(_query_data[2]  == SDS011_MSG_TYPE_DATA, "message type");
+static_assert(_query_data[17] == 0x02, "checksum");
+static_assert(_query_data[18] == SDS011_FRAME_END, "frame end");
+static_assert(frames::set_sleep_on(0xA160)[17] == 0x08, "checksum");
+
+static void assert_frame(frames::frame_t const &frame, sds011_msg_t msg) {
+  uint8_t ref[SDS011_QUERY_PACKET_SIZE];
+  msg.src = SDS011_MSG_SRC_HOST;
+  assert_int_equal(sds011_builder_build(&msg, ref, sizeof(ref)), SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(frame.data(), ref, sizeof(ref));
+}
+
+static sds011_msg_t msg(uint16_t dev_id, sds011_msg_type_t type, sds011_msg_op_t op) {
+  sds011_msg_t m{};
+  m.dev_id = dev_id;
+  m.type   = type;
+  m.op     = op;
+  return m;
+}
+
+static void test_frames_match_builder(void **state) {
+  (void)state;
+
+  for (uint32_t id : { 0x0000u, 0xA160u, 0xFFFFu }) {
+    uint16_t dev_id = static_cast<uint16_t>(id);
+    sds011_msg_t m;
+
+    assert_frame(frames::query_data(dev_id),
+      msg(dev_id, SDS011_MSG_TYPE_DATA, SDS011_MSG_OP_GET));
+
+    m = msg(dev_id, SDS011_MSG_TYPE_DEV_ID, SDS011_MSG_OP_SET);
+    m.data.new_dev_id = 0xA001;
+    assert_frame(frames::set_device_id(dev_id, 0xA001), m);
+
+    m = msg(dev_id, SDS011_MSG_TYPE_REP_MODE, SDS011_MSG_OP_SET);
+    m.data.rep_mode = SDS011_REP_MODE_ACTIVE;
+    assert_frame(frames::set_rep_mode_active(dev_id), m);
+    m.data.rep_mode = SDS011_REP_MODE_QUERY;
+    assert_frame(frames::set_rep_mode_query(dev_id), m);
+    assert_frame(frames::get_rep_mode(dev_id),
+      msg(dev_id, SDS011_MSG_TYPE_REP_MODE, SDS011_MSG_OP_GET));
+
+    m = msg(dev_id, SDS011_MSG_TYPE_SLEEP, SDS011_MSG_OP_SET);
+    m.data.sleep = SDS011_SLEEP_ON;
+    assert_frame(frames::set_sleep_on(dev_id), m);
+    m.data.sleep = SDS011_SLEEP_OFF;
+    assert_frame(frames::set_sleep_off(dev_id), m);
+    assert_frame(frames::get_sleep(dev_id),
+      msg(dev_id, SDS011_MSG_TYPE_SLEEP, SDS011_MSG_OP_GET));
+
+    m = msg(dev_id, SDS011_MSG_TYPE_OP_MODE, SDS011_MSG_OP_SET);
+    m.data.op_mode.mode = SDS011_OP_MODE_CONTINOUS;
+    assert_frame(frames::set_op_mode_continous(dev_id), m);
+    m.data.op_mode.mode = SDS011_OP_MODE_INTERVAL;
+    m.data.op_mode.interval = 30;
+    assert_frame(frames::set_op_mode_periodic(30, dev_id), m);
+    assert_frame(frames::get_op_mode(dev_id),
+      msg(dev_id, SDS011_MSG_TYPE_OP_MODE, SDS011_MSG_OP_GET));
+
+    assert_frame(frames::get_fw_ver(dev_id),
+      msg(dev_id, SDS011_MSG_TYPE_FW_VER, SDS011_MSG_OP_GET));
+  }
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_frames_match_builder),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
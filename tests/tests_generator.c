@@ -0,0 +1,158 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+
+#include "../tools/sds011_generator.h"
+#include "../src/sds011_parser.h"
+
+#define BUFFER_SIZE (64 * 1024)
+
+static uint8_t buffer[BUFFER_SIZE];
+
+static sds011_generator_cfg_t default_cfg(void) {
+  return (sds011_generator_cfg_t) {
+    .dev_id_base  = 0x1000,
+    .dev_count    = 16,
+    .pm_dist      = SDS011_GENERATOR_PM_UNIFORM,
+    .pm_min       = 100,
+    .pm_max       = 200,
+    .reply_rate   = 0,
+    .corrupt_rate = 0,
+    .seed         = 1,
+  };
+}
+
+static size_t parse(uint8_t const *buf, size_t len, sds011_msg_t *msgs, size_t count) {
+  sds011_parser_t parser;
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+  return sds011_parser_parse_buffer(&parser, buf, len, msgs, count, NULL);
+}
+
+static void test_generator_init(void **state) {
+  (void)state;
+
+  sds011_generator_t gen;
+  sds011_generator_cfg_t cfg = default_cfg();
+
+  assert_int_equal(sds011_generator_init(NULL, &cfg), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_generator_init(&gen, NULL), SDS011_ERR_INVALID_PARAM);
+  cfg.dev_count = 0;
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_ERR_INVALID_PARAM);
+  cfg = default_cfg();
+  cfg.pm_min = 300;
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_ERR_INVALID_PARAM);
+  cfg = default_cfg();
+  cfg.corrupt_rate = 1000001;
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_ERR_INVALID_PARAM);
+  cfg = default_cfg();
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_OK);
+
+  assert_int_equal(sds011_generator_fill(NULL, buffer, sizeof(buffer), 10), 0);
+  assert_int_equal(sds011_generator_fill(&gen, NULL, sizeof(buffer), 10), 0);
+  assert_int_equal(sds011_generator_fill(&gen, buffer, SDS011_REPLY_PACKET_SIZE - 1, 10), 0);
+  assert_int_equal(sds011_generator_fill(&gen, buffer, sizeof(buffer), 0), 0);
+}
+
+static void test_generator_samples(void **state) {
+  (void)state;
+
+  static sds011_msg_t msgs[BUFFER_SIZE / SDS011_REPLY_PACKET_SIZE];
+  sds011_generator_t gen;
+  sds011_generator_stats_t stats;
+  sds011_generator_cfg_t cfg = default_cfg();
+
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_OK);
+  size_t len = sds011_generator_fill(&gen, buffer, sizeof(buffer), 5000);
+  assert_int_equal(len, 5000 * SDS011_REPLY_PACKET_SIZE);
+
+  sds011_generator_get_stats(&gen, &stats);
+  assert_int_equal(stats.frames, 5000);
+  assert_int_equal(stats.replies, 0);
+  assert_int_equal(stats.corrupted, 0);
+
+  bool seen[16] = { false };
+  assert_int_equal(parse(buffer, len, msgs, 5000), 5000);
+  for (size_t i = 0; i < 5000; i++) {
+    assert_int_equal(msgs[i].type, SDS011_MSG_TYPE_DATA);
+    assert_true(msgs[i].dev_id >= 0x1000 && msgs[i].dev_id < 0x1010);
+    assert_true(msgs[i].data.sample.pm2_5 >= 100 && msgs[i].data.sample.pm2_5 <= 200);
+    assert_true(msgs[i].data.sample.pm10 >= msgs[i].data.sample.pm2_5);
+    seen[msgs[i].dev_id - 0x1000] = true;
+  }
+  for (size_t i = 0; i < 16; i++) {
+    assert_true(seen[i]);
+  }
+
+  // same seed, same stream
+  static uint8_t again[BUFFER_SIZE];
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_OK);
+  assert_int_equal(sds011_generator_fill(&gen, again, sizeof(again), 5000), len);
+  assert_memory_equal(buffer, again, len);
+}
+
+static void test_generator_normal(void **state) {
+  (void)state;
+
+  static sds011_msg_t msgs[BUFFER_SIZE / SDS011_REPLY_PACKET_SIZE];
+  sds011_generator_t gen;
+  sds011_generator_cfg_t cfg = default_cfg();
+  cfg.pm_dist = SDS011_GENERATOR_PM_NORMAL;
+  cfg.pm_mean = 500;
+  cfg.pm_stddev = 50;
+
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_OK);
+  size_t len = sds011_generator_fill(&gen, buffer, sizeof(buffer), 6000);
+  assert_int_equal(parse(buffer, len, msgs, 6000), 6000);
+
+  uint64_t sum = 0;
+  size_t within = 0;
+  for (size_t i = 0; i < 6000; i++) {
+    uint16_t pm = msgs[i].data.sample.pm2_5;
+    sum += pm;
+    within += (pm >= 450 && pm <= 550) ? 1 : 0;
+  }
+  assert_true(sum / 6000 >= 495 && sum / 6000 <= 505);
+  assert_true(within > 6000 * 60 / 100 && within < 6000 * 76 / 100); // ~68%
+}
+
+static void test_generator_replies_and_corruption(void **state) {
+  (void)state;
+
+  static sds011_msg_t msgs[BUFFER_SIZE / SDS011_REPLY_PACKET_SIZE];
+  sds011_generator_t gen;
+  sds011_generator_stats_t stats;
+  sds011_generator_cfg_t cfg = default_cfg();
+  cfg.reply_rate = 100000;   // 10%
+  cfg.corrupt_rate = 50000;  // 5%
+
+  assert_int_equal(sds011_generator_init(&gen, &cfg), SDS011_OK);
+  size_t len = sds011_generator_fill(&gen, buffer, sizeof(buffer), 6000);
+  sds011_generator_get_stats(&gen, &stats);
+
+  assert_int_equal(stats.frames, 6000);
+  assert_true(stats.replies > 500 && stats.replies < 700);
+  assert_true(stats.corrupted > 200 && stats.corrupted < 400);
+  assert_true(len < 6000 * SDS011_REPLY_PACKET_SIZE);
+
+  size_t ready = parse(buffer, len, msgs, 6000);
+  size_t replies = 0;
+  for (size_t i = 0; i < ready; i++) {
+    replies += msgs[i].type != SDS011_MSG_TYPE_DATA ? 1 : 0;
+  }
+  assert_int_equal(ready, stats.frames - stats.corrupted);
+  assert_true(replies > 0);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_generator_init),
+    cmocka_unit_test(test_generator_samples),
+    cmocka_unit_test(test_generator_normal),
+    cmocka_unit_test(test_generator_replies_and_corruption),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,133 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../src/sds011_mpsc_fifo.h"
+
+#define PRODUCERS 4
+#define ITERATIONS (100 * 1000)
+
+typedef struct {
+  uint32_t producer;
+  uint32_t seq;
+} item_t;
+
+static void test_mpsc_init_params(void **state) {
+  (void)state;
+
+  sds011_mpsc_fifo_t fifo;
+  alignas(SDS011_MPSC_FIFO_ALIGN) uint8_t mem[SDS011_MPSC_FIFO_MEM_SIZE(sizeof(item_t), 4)];
+
+  assert_false(sds011_mpsc_fifo_init(NULL, sizeof(item_t), mem, sizeof(mem)));
+  assert_false(sds011_mpsc_fifo_init(&fifo, 0, mem, sizeof(mem)));
+  assert_false(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), NULL, sizeof(mem)));
+  assert_false(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem, 0));
+  assert_false(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem + 1, sizeof(mem) - 1));
+  assert_false(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem,
+                                     SDS011_MPSC_FIFO_CELL_SIZE(sizeof(item_t)) - 1));
+  // a single cell cannot tell a full fifo from an empty one
+  assert_false(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem,
+                                     SDS011_MPSC_FIFO_MEM_SIZE(sizeof(item_t), 1)));
+  assert_true (sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem,
+                                     SDS011_MPSC_FIFO_MEM_SIZE(sizeof(item_t), 2)));
+  assert_true (sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem, sizeof(mem)));
+  assert_int_equal(fifo.count, 4);
+
+  item_t el = { 0, 0 };
+  assert_false(sds011_mpsc_fifo_push(NULL, &el));
+  assert_false(sds011_mpsc_fifo_push(&fifo, NULL));
+  assert_false(sds011_mpsc_fifo_pop(NULL, &el));
+  assert_false(sds011_mpsc_fifo_pop(&fifo, NULL));
+}
+
+static void test_mpsc_push_pop(void **state) {
+  (void)state;
+
+  sds011_mpsc_fifo_t fifo;
+  alignas(SDS011_MPSC_FIFO_ALIGN) uint8_t mem[SDS011_MPSC_FIFO_MEM_SIZE(sizeof(item_t), 3)];
+  item_t el;
+
+  assert_true(sds011_mpsc_fifo_init(&fifo, sizeof(item_t), mem, sizeof(mem)));
+  assert_false(sds011_mpsc_fifo_pop(&fifo, &el));
+
+  // all cells can be used
+  for (uint32_t round = 0; round < 5; round++) {
+    for (uint32_t i = 0; i < 3; i++) {
+      el = (item_t) { round, i };
+      assert_true(sds011_mpsc_fifo_push(&fifo, &el));
+    }
+    assert_false(sds011_mpsc_fifo_push(&fifo, &el));
+
+    for (uint32_t i = 0; i < 3; i++) {
+      assert_true(sds011_mpsc_fifo_pop(&fifo, &el));
+      assert_int_equal(el.producer, round);
+      assert_int_equal(el.seq, i);
+    }
+    assert_false(sds011_mpsc_fifo_pop(&fifo, &el));
+  }
+}
+
+static sds011_mpsc_fifo_t thread_fifo;
+static alignas(SDS011_MPSC_FIFO_ALIGN) uint8_t thread_mem[SDS011_MPSC_FIFO_MEM_SIZE(sizeof(item_t), 16)];
+
+static void *producer(void *arg) {
+  uint32_t id = (uint32_t)(uintptr_t)arg;
+  for (uint32_t i = 0; i < ITERATIONS; ) {
+    if (sds011_mpsc_fifo_push(&thread_fifo, &(item_t) { id, i }) == false) {
+      sched_yield();
+      continue;
+    }
+    i++;
+  }
+  return NULL;
+}
+
+// Every element pushed by the producers is received once, and the
+// elements of every producer are received in order.
+static void test_mpsc_threads(void **state) {
+  (void)state;
+
+  pthread_t threads[PRODUCERS];
+  uint32_t expected[PRODUCERS] = { 0 };
+  size_t errors = 0;
+
+  assert_true(sds011_mpsc_fifo_init(&thread_fifo, sizeof(item_t), thread_mem, sizeof(thread_mem)));
+
+  for (uintptr_t i = 0; i < PRODUCERS; i++) {
+    assert_int_equal(pthread_create(&threads[i], NULL, producer, (void *)i), 0);
+  }
+
+  for (size_t received = 0; received < PRODUCERS * ITERATIONS; ) {
+    item_t el;
+    if (sds011_mpsc_fifo_pop(&thread_fifo, &el) == false) {
+      sched_yield();
+      continue;
+    }
+    if (el.producer >= PRODUCERS || el.seq != expected[el.producer]) {
+      errors++;
+    } else {
+      expected[el.producer]++;
+    }
+    received++;
+  }
+
+  for (size_t i = 0; i < PRODUCERS; i++) {
+    assert_int_equal(pthread_join(threads[i], NULL), 0);
+    assert_int_equal(expected[i], ITERATIONS);
+  }
+  assert_int_equal(errors, 0);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_mpsc_init_params),
+    cmocka_unit_test(test_mpsc_push_pop),
+    cmocka_unit_test(test_mpsc_threads),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
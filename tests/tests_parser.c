@@ -590,6 +590,324 @@ static void test_parser_op_mode_invalid_data(void **state) {
   assert_int_equal(sds011_parser_get_error(&parser), SDS011_ERR_INVALID_DATA);
 }
 
+static void test_parser_parse_buffer(void **state) {
+  (void)state;
+  sds011_parser_init(&parser);
+
+  uint8_t buf[] = {
+    0x00, 0x12, 0xAB,
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB,
+    0x55,
+    0xAA, 0xC5, 0x07, 0x0F, 0x07, 0x0A, 0xA1, 0x60, 0x28, 0xAB,
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1E, 0xAB, // invalid crc
+    0xAA, 0xB4, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x02, 0xAB,
+  };
+  sds011_msg_t msgs[4];
+  size_t consumed;
+
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, buf, sizeof(buf), msgs, 4, &consumed), 3);
+  assert_int_equal(consumed, sizeof(buf));
+
+  assert_int_equal(msgs[0].type,              SDS011_MSG_TYPE_DATA);
+  assert_int_equal(msgs[0].dev_id,            0xA160);
+  assert_int_equal(msgs[0].data.sample.pm2_5, 1236);
+  assert_int_equal(msgs[0].data.sample.pm10,  2618);
+  assert_int_equal(msgs[1].type,              SDS011_MSG_TYPE_FW_VER);
+  assert_int_equal(msgs[1].data.fw_ver.year,  15);
+  assert_int_equal(msgs[2].type,              SDS011_MSG_TYPE_DATA);
+  assert_int_equal(msgs[2].src,               SDS011_MSG_SRC_HOST);
+  assert_int_equal(msgs[2].dev_id,            0xFFFF);
+
+  // output array full
+  sds011_parser_init(&parser);
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, buf, sizeof(buf), msgs, 1, &consumed), 1);
+  assert_int_equal(consumed, 13);
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, &buf[consumed], sizeof(buf) - consumed, msgs, 4, &consumed), 2);
+  assert_int_equal(msgs[0].type, SDS011_MSG_TYPE_FW_VER);
+
+  // packet split between calls
+  sds011_parser_init(&parser);
+  for (size_t split = 1; split < 13; split++) {
+    assert_int_equal(sds011_parser_parse_buffer(
+      &parser, buf, split, msgs, 4, &consumed), 0);
+    assert_int_equal(consumed, split);
+    assert_int_equal(sds011_parser_parse_buffer(
+      &parser, &buf[split], 13 - split, msgs, 4, NULL), 1);
+    assert_int_equal(msgs[0].dev_id, 0xA160);
+    assert_int_equal(msgs[0].data.sample.pm2_5, 1236);
+  }
+
+  // invalid params
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, NULL, sizeof(buf), msgs, 4, &consumed), 0);
+  assert_int_equal(consumed, 0);
+}
+
+static void test_parser_resync(void **state) {
+  (void)state;
+
+  uint8_t buf[] = {
+    0xAA, 0xC0, 0xD4, 0x04, // truncated packet
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB,
+    0xAA, 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB,
+  };
+  sds011_msg_t msgs[4];
+
+  // without resync the truncated packet swallows the next one
+  sds011_parser_init(&parser);
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, buf, sizeof(buf), msgs, 4, NULL), 0);
+
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, buf, sizeof(buf), msgs, 4, NULL), 2);
+  assert_int_equal(msgs[0].dev_id,            0xA160);
+  assert_int_equal(msgs[0].data.sample.pm2_5, 1236);
+  assert_int_equal(msgs[1].dev_id,            0xA160);
+  assert_int_equal(msgs[1].data.sample.pm10,  2618);
+  assert_int_equal(sds011_parser_get_skipped(&parser), 5);
+
+  // byte by byte
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+  size_t ready = 0;
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    if (sds011_parser_parse(&parser, buf[i]) == SDS011_PARSER_RES_READY) {
+      sds011_parser_get_msg(&parser, &msgs[ready++]);
+    }
+  }
+  assert_int_equal(ready, 2);
+  assert_int_equal(msgs[1].data.sample.pm2_5, 1236);
+  assert_int_equal(sds011_parser_get_skipped(&parser), 5);
+  assert_int_equal(sds011_parser_get_frame_tail(&parser), 0);
+
+  // packet found within a dropped query ends before the failing crc byte
+  uint8_t nested[SDS011_QUERY_PACKET_SIZE] = { 0xAA, 0xB4 };
+  uint8_t crc = 0;
+  memcpy(&nested[2], &buf[4], SDS011_REPLY_PACKET_SIZE);
+  for (size_t i = 2; i < SDS011_QUERY_PACKET_SIZE - 2; i++) {
+    crc += nested[i];
+  }
+  nested[SDS011_QUERY_PACKET_SIZE - 2] = (uint8_t)(crc + 1);
+  nested[SDS011_QUERY_PACKET_SIZE - 1] = SDS011_FRAME_END;
+
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+  for (size_t i = 0; i < SDS011_QUERY_PACKET_SIZE - 2; i++) {
+    assert_int_equal(sds011_parser_parse(&parser, nested[i]), SDS011_PARSER_RES_RUNNING);
+  }
+  assert_int_equal(sds011_parser_parse(&parser, nested[SDS011_QUERY_PACKET_SIZE - 2]),
+                   SDS011_PARSER_RES_READY);
+  assert_int_equal(sds011_parser_get_frame_tail(&parser), 6);
+}
+
+static void test_parser_resync_failing_byte(void **state) {
+  (void)state;
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+
+  uint8_t msg[] = { 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB };
+
+  // the failing end byte starts the next packet
+  for (int i = 0; i < 9; i++) {
+    assert_int_equal(sds011_parser_parse(&parser, msg[i]), SDS011_PARSER_RES_RUNNING);
+  }
+  assert_int_equal(sds011_parser_parse(&parser, 0xAA), SDS011_PARSER_RES_ERROR);
+  assert_int_equal(sds011_parser_get_error(&parser), SDS011_ERR_PARSER_FRAME_END);
+  assert_int_equal(parser.state, 1);
+  assert_int_equal(sds011_parser_get_skipped(&parser), 9);
+
+  for (int i = 1; i < 9; i++) {
+    assert_int_equal(sds011_parser_parse(&parser, msg[i]), SDS011_PARSER_RES_RUNNING);
+  }
+  assert_int_equal(sds011_parser_parse(&parser, msg[9]), SDS011_PARSER_RES_READY);
+}
+
+static void test_parser_lazy_frame(void **state) {
+  (void)state;
+  sds011_parser_init(&parser);
+  sds011_parser_set_lazy(&parser, true);
+
+  uint8_t res[] = { 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB };
+  uint8_t req[] = {
+    0xAA, 0xB4, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xA0, 0x01, 0xA1,
+    0x60, 0xA7, 0xAB
+  };
+  sds011_frame_t frame;
+  sds011_msg_t msg;
+
+  // no packet completed yet
+  memset(&msg, 0xFF, sizeof(msg));
+  sds011_parser_get_msg(&parser, &msg);
+  assert_int_equal(msg.dev_id, 0);
+  assert_int_equal(msg.type,   0);
+
+  parse_buffer(res, sizeof(res), &msg);
+  assert_int_equal(msg.dev_id,            0xA160);
+  assert_int_equal(msg.data.sample.pm2_5, 1236);
+
+  sds011_parser_get_frame(&parser, &frame);
+  assert_int_equal(sds011_frame_get_type(&frame),   SDS011_MSG_TYPE_DATA);
+  assert_int_equal(sds011_frame_get_src(&frame),    SDS011_MSG_SRC_SENSOR);
+  assert_int_equal(sds011_frame_get_dev_id(&frame), 0xA160);
+  assert_int_equal(sds011_frame_get_sample(&frame).pm2_5, 1236);
+  assert_int_equal(sds011_frame_get_sample(&frame).pm10,  2618);
+
+  // the view stays valid while the next packet is parsed
+  for (size_t i = 0; i < sizeof(req) - 1; i++) {
+    assert_int_equal(sds011_parser_parse(&parser, req[i]), SDS011_PARSER_RES_RUNNING);
+  }
+  assert_int_equal(sds011_frame_get_dev_id(&frame), 0xA160);
+  assert_int_equal(sds011_frame_get_sample(&frame).pm10, 2618);
+  sds011_parser_get_msg(&parser, &msg);
+  assert_int_equal(msg.type, SDS011_MSG_TYPE_DATA);
+
+  assert_int_equal(sds011_parser_parse(&parser, req[sizeof(req) - 1]), SDS011_PARSER_RES_READY);
+  sds011_parser_get_frame(&parser, &frame);
+  assert_int_equal(sds011_frame_get_type(&frame),   SDS011_MSG_TYPE_DEV_ID);
+  assert_int_equal(sds011_frame_get_src(&frame),    SDS011_MSG_SRC_HOST);
+  assert_int_equal(sds011_frame_get_dev_id(&frame), 0xA160);
+  assert_int_equal(sds011_frame_get_sample(&frame).pm2_5, 0);
+
+  sds011_parser_get_msg(&parser, &msg);
+  assert_int_equal(msg.type,            SDS011_MSG_TYPE_DEV_ID);
+  assert_int_equal(msg.data.new_dev_id, 0xA001);
+
+  // invalid data is still reported when the packet is completed
+  uint8_t inv[] = { 0xAA, 0xC5, 0x08, 0x02, 0x00, 0x00, 0xA1, 0x60, 0x0B, 0xAB };
+  for (size_t i = 0; i < sizeof(inv) - 1; i++) {
+    assert_int_equal(sds011_parser_parse(&parser, inv[i]), SDS011_PARSER_RES_RUNNING);
+  }
+  assert_int_equal(sds011_parser_parse(&parser, inv[sizeof(inv) - 1]), SDS011_PARSER_RES_ERROR);
+  assert_int_equal(sds011_parser_get_error(&parser), SDS011_ERR_INVALID_DATA);
+}
+
+static void test_parser_get_sample(void **state) {
+  (void)state;
+
+  uint8_t res[] = { 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB };
+  uint8_t rep[] = { 0xAA, 0xC5, 0x02, 0x01, 0x01, 0x00, 0xA1, 0x60, 0x05, 0xAB };
+  uint16_t dev_id = 0;
+  sds011_sample_t sample = { 0, 0 };
+  sds011_msg_t msg;
+
+  sds011_parser_init(&parser);
+  assert_false(sds011_parser_get_sample(&parser, &dev_id, &sample));
+
+  parse_buffer(res, sizeof(res), &msg);
+  assert_true(sds011_parser_get_sample(&parser, &dev_id, &sample));
+  assert_int_equal(dev_id,       0xA160);
+  assert_int_equal(sample.pm2_5, 1236);
+  assert_int_equal(sample.pm10,  2618);
+
+  // fast path decodes the same message as the generic one
+  assert_int_equal(msg.dev_id,            0xA160);
+  assert_int_equal(msg.type,              SDS011_MSG_TYPE_DATA);
+  assert_int_equal(msg.op,                SDS011_MSG_OP_GET);
+  assert_int_equal(msg.src,               SDS011_MSG_SRC_SENSOR);
+  assert_int_equal(msg.data.sample.pm2_5, 1236);
+  assert_int_equal(msg.data.sample.pm10,  2618);
+
+  parse_buffer(rep, sizeof(rep), &msg);
+  assert_int_equal(msg.type, SDS011_MSG_TYPE_REP_MODE);
+  assert_false(sds011_parser_get_sample(&parser, &dev_id, &sample));
+
+  // no bytes of a previously decoded union member are left
+  uint8_t op_mode[] = { 0xAA, 0xC5, 0x08, 0x01, 0x05, 0x00, 0xA1, 0x60, 0x0F, 0xAB };
+  sds011_msg_t expected;
+  memset(&expected, 0, sizeof(expected));
+  expected.dev_id            = 0xA160;
+  expected.type              = SDS011_MSG_TYPE_DATA;
+  expected.op                = SDS011_MSG_OP_GET;
+  expected.src               = SDS011_MSG_SRC_SENSOR;
+  expected.data.sample.pm2_5 = 1236;
+  expected.data.sample.pm10  = 2618;
+
+  parse_buffer(op_mode, sizeof(op_mode), &msg);
+  assert_int_equal(msg.data.op_mode.interval, 5);
+  parse_buffer(res, sizeof(res), &msg);
+  assert_memory_equal(&msg, &expected, sizeof(msg));
+
+  // lazy mode
+  sds011_parser_set_lazy(&parser, true);
+  res[2] = 0xD5; res[8] = 0x1E;
+  parse_buffer(res, sizeof(res), &msg);
+  assert_true(sds011_parser_get_sample(&parser, &dev_id, &sample));
+  assert_int_equal(sample.pm2_5, 1237);
+  assert_int_equal(msg.data.sample.pm2_5, 1237);
+}
+
+static void test_parser_stats(void **state) {
+  (void)state;
+  sds011_parser_init(&parser);
+
+  uint8_t buf[] = {
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB, // data
+    0x00, 0x11,                                                 // noise
+    0xAA, 0xC1,                                                 // bad command
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1E, 0xAB, // bad crc
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAC, // bad end
+    0xAA, 0xC5, 0x08, 0x02, 0x00, 0x00, 0xA1, 0x60, 0x0B, 0xAB, // invalid op
+    0xAA, 0xC5, 0x03, 0x00, 0x00, 0x00, 0xA1, 0x60, 0x04, 0xAB, // reserved type
+    0xAA, 0xB4, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // dev id
+    0x00, 0x00, 0x00, 0xA0, 0x01, 0xA1, 0x60, 0xA7, 0xAB,
+  };
+  sds011_msg_t msgs[8];
+  sds011_parser_stats_t stats;
+
+  assert_int_equal(sds011_parser_parse_buffer(
+    &parser, buf, sizeof(buf), msgs, 8, NULL), 2);
+
+  sds011_parser_get_stats(&parser, &stats);
+  assert_int_equal(stats.frames[SDS011_MSG_TYPE_DATA],   1);
+  assert_int_equal(stats.frames[SDS011_MSG_TYPE_DEV_ID], 1);
+  assert_int_equal(stats.frames[SDS011_MSG_TYPE_SLEEP],  0);
+  assert_int_equal(stats.cmd_errors,   1);
+  assert_int_equal(stats.crc_errors,   1);
+  assert_int_equal(stats.end_errors,   1);
+  assert_int_equal(stats.invalid_type, 1);
+  assert_int_equal(stats.invalid_data, 1);
+  assert_int_equal(stats.skipped,      24);
+  assert_int_equal(sds011_parser_get_skipped(&parser), 24);
+
+  // the latest error does not overwrite the counters
+  assert_int_equal(sds011_parser_parse(&parser, 0x00), SDS011_PARSER_RES_ERROR);
+  sds011_parser_get_stats(&parser, &stats);
+  assert_int_equal(stats.crc_errors, 1);
+  assert_int_equal(stats.skipped,    25);
+
+  sds011_parser_reset_stats(&parser);
+  sds011_parser_get_stats(&parser, &stats);
+  assert_int_equal(stats.frames[SDS011_MSG_TYPE_DATA], 0);
+  assert_int_equal(stats.crc_errors, 0);
+  assert_int_equal(stats.skipped,    0);
+}
+
+static void test_frame_init(void **state) {
+  (void)state;
+
+  uint8_t res[] = { 0xAA, 0xC5, 0x07, 0x0F, 0x07, 0x0A, 0xA1, 0x60, 0x28, 0xAB };
+  sds011_frame_t frame;
+  sds011_msg_t msg;
+
+  sds011_frame_init(&frame, res);
+  assert_int_equal(sds011_frame_get_type(&frame),   SDS011_MSG_TYPE_FW_VER);
+  assert_int_equal(sds011_frame_get_dev_id(&frame), 0xA160);
+  assert_int_equal(sds011_frame_get_msg(&frame, &msg), SDS011_OK);
+  assert_int_equal(msg.data.fw_ver.year,  15);
+  assert_int_equal(msg.data.fw_ver.month, 7);
+  assert_int_equal(msg.data.fw_ver.day,   10);
+
+  res[2] = 0x09;
+  assert_int_equal(sds011_frame_get_msg(&frame, &msg), SDS011_ERR_INVALID_MSG_TYPE);
+}
+
 int main(void) {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_parser_sync_byte),
@@ -612,6 +930,13 @@ int main(void) {
     cmocka_unit_test(test_parser_rep_mode_invalid_data),
     cmocka_unit_test(test_parser_sleep_invalid_data),
     cmocka_unit_test(test_parser_op_mode_invalid_data),
+    cmocka_unit_test(test_parser_parse_buffer),
+    cmocka_unit_test(test_parser_resync),
+    cmocka_unit_test(test_parser_resync_failing_byte),
+    cmocka_unit_test(test_parser_lazy_frame),
+    cmocka_unit_test(test_frame_init),
+    cmocka_unit_test(test_parser_stats),
+    cmocka_unit_test(test_parser_get_sample),
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,209 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+
+#include "../src/sds011_parser_pool.h"
+#include "../src/sds011_parser.h"
+
+static sds011_parser_pool_t pool;
+
+static uint8_t const _reply[] = {
+  0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB
+};
+static uint8_t const _query[] = {
+  0xAA, 0xB4, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0xA0, 0x01, 0xA1,
+  0x60, 0xA7, 0xAB
+};
+
+static void test_pool_init(void **state) {
+  (void)state;
+
+  assert_int_equal(sds011_parser_pool_init(NULL, 1), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_parser_pool_init(&pool, SDS011_PARSER_POOL_SIZE + 1),
+    SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_parser_pool_init(&pool, SDS011_PARSER_POOL_SIZE), SDS011_OK);
+  assert_int_equal(sds011_parser_pool_get_error(&pool, 0), SDS011_OK);
+  assert_int_equal(sds011_parser_pool_get_error(&pool, SDS011_PARSER_POOL_SIZE),
+    SDS011_ERR_INVALID_PARAM);
+}
+
+static void test_pool_interleaved(void **state) {
+  (void)state;
+
+  sds011_parser_pool_msg_t msgs[8];
+  sds011_parser_pool_chunk_t chunks[] = {
+    { .stream = 2, .buf = &_query[0], .len = 7  },
+    { .stream = 0, .buf = &_reply[0], .len = 4  },
+    { .stream = 1, .buf = &_reply[0], .len = 10 },
+    { .stream = 0, .buf = &_reply[4], .len = 6  },
+    { .stream = 2, .buf = &_query[7], .len = 12 },
+  };
+
+  assert_int_equal(sds011_parser_pool_init(&pool, 3), SDS011_OK);
+  assert_int_equal(sds011_parser_pool_parse(&pool, chunks, 5, msgs, 8), 3);
+
+  assert_int_equal(msgs[0].stream, 1);
+  assert_int_equal(msgs[0].msg.type, SDS011_MSG_TYPE_DATA);
+  assert_int_equal(msgs[0].msg.data.sample.pm2_5, 1236);
+  assert_int_equal(msgs[1].stream, 0);
+  assert_int_equal(msgs[1].msg.dev_id, 0xA160);
+  assert_int_equal(msgs[1].msg.data.sample.pm10, 2618);
+  assert_int_equal(msgs[2].stream, 2);
+  assert_int_equal(msgs[2].msg.type, SDS011_MSG_TYPE_DEV_ID);
+  assert_int_equal(msgs[2].msg.src, SDS011_MSG_SRC_HOST);
+  assert_int_equal(msgs[2].msg.data.new_dev_id, 0xA001);
+
+  for (size_t i = 0; i < 5; i++) {
+    assert_int_equal(chunks[i].len, 0);
+  }
+}
+
+static void test_pool_msgs_full(void **state) {
+  (void)state;
+
+  uint8_t buf[3 * sizeof(_reply)];
+  for (size_t i = 0; i < 3; i++) {
+    memcpy(&buf[i * sizeof(_reply)], _reply, sizeof(_reply));
+  }
+
+  sds011_parser_pool_msg_t msgs[2];
+  sds011_parser_pool_chunk_t chunks[] = {
+    { .stream = 0, .buf = buf, .len = sizeof(buf) },
+    { .stream = 1, .buf = buf, .len = sizeof(buf) },
+    { .stream = 9, .buf = buf, .len = sizeof(buf) }, // unknown stream
+  };
+
+  assert_int_equal(sds011_parser_pool_init(&pool, 2), SDS011_OK);
+  assert_int_equal(sds011_parser_pool_parse(&pool, chunks, 3, msgs, 2), 2);
+  assert_int_equal(chunks[0].len, sizeof(_reply));
+  assert_int_equal(chunks[1].len, sizeof(buf));
+
+  size_t total = 2;
+  while (chunks[0].len > 0 || chunks[1].len > 0) {
+    size_t ready = sds011_parser_pool_parse(&pool, chunks, 3, msgs, 2);
+    assert_true(ready > 0);
+    total += ready;
+  }
+  assert_int_equal(total, 6);
+  assert_int_equal(msgs[1].stream, 1);
+  assert_int_equal(chunks[2].len, sizeof(buf));
+
+  // invalid params
+  assert_int_equal(sds011_parser_pool_parse(NULL, chunks, 3, msgs, 2), 0);
+  assert_int_equal(sds011_parser_pool_parse(&pool, NULL, 3, msgs, 2), 0);
+  assert_int_equal(sds011_parser_pool_parse(&pool, chunks, 3, NULL, 2), 0);
+}
+
+static void test_pool_errors(void **state) {
+  (void)state;
+
+  uint8_t buf[] = {
+    0x00, 0xAA, 0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB, // noise
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1E,                   // bad crc
+    0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAA,             // bad end
+    0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB,
+    0xAA, 0xC5, 0x08, 0x00, 31, 0x00, 0xA1, 0x60, 0x28, 0xAB,               // invalid data
+  };
+  sds011_parser_pool_msg_t msgs[4];
+  sds011_parser_pool_chunk_t chunk;
+
+  assert_int_equal(sds011_parser_pool_init(&pool, 1), SDS011_OK);
+
+  chunk = (sds011_parser_pool_chunk_t) { .stream = 0, .buf = buf, .len = 12 };
+  assert_int_equal(sds011_parser_pool_parse(&pool, &chunk, 1, msgs, 4), 1);
+  assert_int_equal(sds011_parser_pool_get_error(&pool, 0), SDS011_OK);
+
+  chunk = (sds011_parser_pool_chunk_t) { .stream = 0, .buf = &buf[12], .len = 9 };
+  assert_int_equal(sds011_parser_pool_parse(&pool, &chunk, 1, msgs, 4), 0);
+  assert_int_equal(sds011_parser_pool_get_error(&pool, 0), SDS011_ERR_PARSER_CRC);
+
+  // failing frame begin starts the next packet
+  chunk = (sds011_parser_pool_chunk_t) { .stream = 0, .buf = &buf[21], .len = 19 };
+  assert_int_equal(sds011_parser_pool_parse(&pool, &chunk, 1, msgs, 4), 1);
+  assert_int_equal(msgs[0].msg.data.sample.pm2_5, 1236);
+
+  chunk = (sds011_parser_pool_chunk_t) { .stream = 0, .buf = &buf[40], .len = 10 };
+  assert_int_equal(sds011_parser_pool_parse(&pool, &chunk, 1, msgs, 4), 0);
+  assert_int_equal(sds011_parser_pool_get_error(&pool, 0), SDS011_ERR_INVALID_DATA);
+}
+
+static void test_pool_matches_parser(void **state) {
+  (void)state;
+
+  // every stream gets the same bytes, split at different positions
+  enum { STREAMS = 64 };
+  uint8_t buf[512];
+  size_t len = 0;
+  uint32_t seed = 7;
+
+  while (len + sizeof(_query) < sizeof(buf)) {
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 4 == 0) {
+      memcpy(&buf[len], _query, sizeof(_query));
+      len += sizeof(_query);
+    } else {
+      memcpy(&buf[len], _reply, sizeof(_reply));
+      len += sizeof(_reply);
+    }
+  }
+
+  sds011_parser_t parser;
+  sds011_msg_t ref[64];
+  sds011_parser_init(&parser);
+  size_t ref_count = sds011_parser_parse_buffer(&parser, buf, len, ref, 64, NULL);
+  assert_true(ref_count > 16);
+
+  sds011_parser_pool_chunk_t chunks[STREAMS];
+  size_t offsets[STREAMS] = { 0 };
+  size_t counts[STREAMS] = { 0 };
+  sds011_parser_pool_msg_t msgs[STREAMS];
+
+  assert_int_equal(sds011_parser_pool_init(&pool, STREAMS), SDS011_OK);
+
+  for (size_t round = 0; ; round++) {
+    size_t n = 0;
+    for (size_t s = 0; s < STREAMS; s++) {
+      if (offsets[s] < len) {
+        size_t step = 1 + (s * 7 + round * 3) % 23;
+        chunks[n++] = (sds011_parser_pool_chunk_t) {
+          .stream = (uint16_t)s,
+          .buf    = &buf[offsets[s]],
+          .len    = step < len - offsets[s] ? step : len - offsets[s],
+        };
+      }
+    }
+    if (n == 0) {
+      break;
+    }
+
+    size_t ready = sds011_parser_pool_parse(&pool, chunks, n, msgs, STREAMS);
+    for (size_t i = 0; i < ready; i++) {
+      sds011_msg_t const *msg = &ref[counts[msgs[i].stream]++];
+      assert_int_equal(msgs[i].msg.type,   msg->type);
+      assert_int_equal(msgs[i].msg.dev_id, msg->dev_id);
+      assert_int_equal(msgs[i].msg.data.sample.pm2_5, msg->data.sample.pm2_5);
+    }
+    for (size_t i = 0; i < n; i++) {
+      offsets[chunks[i].stream] = (size_t)(chunks[i].buf - buf);
+    }
+  }
+
+  for (size_t s = 0; s < STREAMS; s++) {
+    assert_int_equal(counts[s], ref_count);
+  }
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_pool_init),
+    cmocka_unit_test(test_pool_interleaved),
+    cmocka_unit_test(test_pool_msgs_full),
+    cmocka_unit_test(test_pool_errors),
+    cmocka_unit_test(test_pool_matches_parser),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,131 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../src/sds011_ring.h"
+
+typedef struct {
+  uint32_t a;
+  uint8_t b[13];
+} item_t;
+
+SDS011_RING_DECLARE(test_ring, item_t, 4);
+SDS011_RING_DECLARE(byte_ring, uint8_t, SDS011_RING_POW2(10));
+
+static void test_ring_pow2(void **state) {
+  (void)state;
+
+  assert_int_equal(SDS011_RING_POW2(0), 1);
+  assert_int_equal(SDS011_RING_POW2(1), 1);
+  assert_int_equal(SDS011_RING_POW2(3), 4);
+  assert_int_equal(SDS011_RING_POW2(10), 16);
+  assert_int_equal(SDS011_RING_POW2(16), 16);
+  assert_int_equal(SDS011_RING_POW2(1000), 1024);
+  assert_int_equal(SDS011_RING_POW2(65536), 65536);
+}
+
+static void test_ring_push_pop(void **state) {
+  (void)state;
+
+  test_ring_t ring;
+  item_t el;
+
+  test_ring_init(&ring, 100); // limited to the capacity
+  assert_int_equal(ring.limit, 4);
+  assert_int_equal(test_ring_count(&ring), 0);
+  assert_false(test_ring_pop(&ring, &el));
+
+  // all slots are used, indices wrap
+  for (uint32_t round = 0; round < 5; round++) {
+    for (uint32_t i = 0; i < 4; i++) {
+      el = (item_t) { .a = round * 10 + i, .b = { [12] = (uint8_t)i } };
+      assert_true(test_ring_push(&ring, &el));
+    }
+    assert_false(test_ring_push(&ring, &el));
+    assert_int_equal(test_ring_count(&ring), 4);
+
+    for (uint32_t i = 0; i < 4; i++) {
+      assert_true(test_ring_pop(&ring, &el));
+      assert_int_equal(el.a, round * 10 + i);
+      assert_int_equal(el.b[12], i);
+    }
+    assert_false(test_ring_pop(&ring, &el));
+  }
+}
+
+static void test_ring_limit(void **state) {
+  (void)state;
+
+  byte_ring_t ring;
+  uint8_t el;
+
+  byte_ring_init(&ring, 10);
+
+  for (uint8_t round = 0; round < 3; round++) {
+    for (uint8_t i = 0; i < 10; i++) {
+      assert_true(byte_ring_push(&ring, &i));
+    }
+    assert_false(byte_ring_push(&ring, &el));
+
+    assert_true(byte_ring_pop(&ring, &el));
+    assert_int_equal(el, 0);
+    assert_true(byte_ring_push(&ring, &el));
+    assert_false(byte_ring_push(&ring, &el));
+
+    for (uint8_t i = 1; i < 10; i++) {
+      assert_true(byte_ring_pop(&ring, &el));
+      assert_int_equal(el, i);
+    }
+    assert_true(byte_ring_pop(&ring, &el));
+    assert_int_equal(el, 0);
+    assert_int_equal(byte_ring_count(&ring), 0);
+  }
+}
+
+static void test_ring_reserve_peek(void **state) {
+  (void)state;
+
+  test_ring_t ring;
+  item_t el;
+
+  test_ring_init(&ring, 3);
+
+  for (uint32_t round = 0; round < 5; round++) {
+    for (uint32_t i = 0; i < 3; i++) {
+      item_t *slot = test_ring_reserve(&ring);
+      assert_non_null(slot);
+      slot->a = round * 10 + i;
+      assert_int_equal(test_ring_count(&ring), i);
+      assert_true(test_ring_commit(&ring));
+    }
+    assert_null(test_ring_reserve(&ring));
+    assert_false(test_ring_commit(&ring));
+
+    // element is used in place and released
+    item_t *head = test_ring_peek(&ring);
+    assert_non_null(head);
+    assert_int_equal(head->a, round * 10);
+    assert_true(test_ring_peek(&ring) == head);
+    assert_true(test_ring_release(&ring));
+
+    assert_true(test_ring_pop(&ring, &el));
+    assert_int_equal(el.a, round * 10 + 1);
+    assert_int_equal(test_ring_peek(&ring)->a, round * 10 + 2);
+    assert_true(test_ring_release(&ring));
+
+    assert_null(test_ring_peek(&ring));
+    assert_false(test_ring_release(&ring));
+  }
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_ring_pow2),
+    cmocka_unit_test(test_ring_push_pop),
+    cmocka_unit_test(test_ring_limit),
+    cmocka_unit_test(test_ring_reserve_peek),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,152 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+
+#include "../src/sds011_scanner.h"
+#include "../src/sds011_parser.h"
+
+static uint8_t const _reply[] = {
+  0xAA, 0xC0, 0xD4, 0x04, 0x3A, 0x0A, 0xA1, 0x60, 0x1D, 0xAB
+};
+static uint8_t const _query[] = {
+  0xAA, 0xB4, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x02, 0xAB
+};
+
+static void test_find(void **state) {
+  (void)state;
+
+  uint8_t buf[100];
+
+  memset(buf, 0, sizeof(buf));
+  assert_int_equal(sds011_scanner_find(buf, sizeof(buf)), sizeof(buf));
+  assert_int_equal(sds011_scanner_find(buf, 0), 0);
+
+  for (size_t pos = 0; pos < sizeof(buf); pos++) {
+    memset(buf, 0xAB, sizeof(buf));
+    buf[pos] = 0xAA;
+    assert_int_equal(sds011_scanner_find(buf, sizeof(buf)), pos);
+    assert_int_equal(sds011_scanner_find(buf, pos), pos);
+    if (pos + 1 < sizeof(buf)) {
+      buf[pos + 1] = 0xAA;
+      assert_int_equal(sds011_scanner_find(buf, sizeof(buf)), pos);
+    }
+  }
+}
+
+static void test_check(void **state) {
+  (void)state;
+
+  uint8_t buf[sizeof(_query)];
+
+  assert_int_equal(sds011_scanner_check(NULL, 0), SDS011_ERR_MEM);
+  assert_int_equal(sds011_scanner_check(_reply, sizeof(_reply)), SDS011_OK);
+  assert_int_equal(sds011_scanner_check(_query, sizeof(_query)), SDS011_OK);
+  assert_int_equal(sds011_scanner_check(_reply, sizeof(_reply) - 1), SDS011_ERR_MEM);
+  assert_int_equal(sds011_scanner_check(_query, sizeof(_reply)), SDS011_ERR_MEM);
+
+  memcpy(buf, _reply, sizeof(_reply));
+  buf[0] = 0x00;
+  assert_int_equal(sds011_scanner_check(buf, sizeof(_reply)), SDS011_ERR_PARSER_FRAME_BEG);
+
+  memcpy(buf, _reply, sizeof(_reply));
+  buf[1] = 0xC1;
+  assert_int_equal(sds011_scanner_check(buf, sizeof(_reply)), SDS011_ERR_PARSER_CMD);
+
+  memcpy(buf, _reply, sizeof(_reply));
+  buf[5] = 0x0B;
+  assert_int_equal(sds011_scanner_check(buf, sizeof(_reply)), SDS011_ERR_PARSER_CRC);
+
+  memcpy(buf, _reply, sizeof(_reply));
+  buf[9] = 0xAC;
+  assert_int_equal(sds011_scanner_check(buf, sizeof(_reply)), SDS011_ERR_PARSER_FRAME_END);
+
+  memcpy(buf, _query, sizeof(_query));
+  buf[16] = 0xFE;
+  assert_int_equal(sds011_scanner_check(buf, sizeof(_query)), SDS011_ERR_PARSER_CRC);
+}
+
+static void test_scan(void **state) {
+  (void)state;
+
+  uint8_t buf[256];
+  size_t len = 0;
+  size_t offsets[16];
+  size_t consumed;
+
+  memset(buf, 0, sizeof(buf));
+  memcpy(&buf[len], _reply, sizeof(_reply)); len += sizeof(_reply);
+  buf[len++] = 0xAA;                                      // garbage
+  memcpy(&buf[len], _query, sizeof(_query)); len += sizeof(_query);
+  memcpy(&buf[len], _reply, sizeof(_reply)); len += 3;    // truncated
+  memcpy(&buf[len], _reply, sizeof(_reply)); len += sizeof(_reply);
+  memcpy(&buf[len], _reply, sizeof(_reply)); len += sizeof(_reply);
+  buf[len - 3] ^= 1;                                      // invalid crc
+  memcpy(&buf[len], _query, sizeof(_query)); len += 5;    // incomplete
+
+  assert_int_equal(sds011_scanner_scan(buf, len, offsets, 16, &consumed), 3);
+  assert_int_equal(offsets[0], 0);
+  assert_int_equal(offsets[1], 11);
+  assert_int_equal(offsets[2], 33);
+  assert_int_equal(consumed, 53);
+
+  // output array full
+  assert_int_equal(sds011_scanner_scan(buf, len, offsets, 2, &consumed), 2);
+  assert_int_equal(consumed, 30);
+  assert_int_equal(sds011_scanner_scan(&buf[consumed], len - consumed, offsets, 16, NULL), 1);
+  assert_int_equal(offsets[0], 3);
+
+  assert_int_equal(sds011_scanner_scan(NULL, len, offsets, 16, &consumed), 0);
+  assert_int_equal(consumed, 0);
+}
+
+static void test_scan_matches_parser(void **state) {
+  (void)state;
+
+  // many packets, more than one batch of candidates
+  uint8_t buf[1024];
+  size_t len = 0;
+  uint32_t seed = 1;
+
+  while (len + sizeof(_query) < sizeof(buf)) {
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 3 == 0) {
+      memcpy(&buf[len], _query, sizeof(_query));
+      len += sizeof(_query);
+    } else {
+      memcpy(&buf[len], _reply, sizeof(_reply));
+      len += sizeof(_reply);
+    }
+    if ((seed >> 18) % 5 == 0) {
+      buf[len - 3] ^= 1; // invalid crc, rejected within a batch
+    }
+    if ((seed >> 20) % 4 == 0) {
+      buf[len++] = (uint8_t)(seed >> 8);
+    }
+  }
+
+  size_t offsets[128];
+  size_t consumed;
+  size_t found = sds011_scanner_scan(buf, len, offsets, 128, &consumed);
+
+  sds011_parser_t parser;
+  sds011_msg_t msgs[128];
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+
+  assert_true(found > 16);
+  assert_int_equal(sds011_parser_parse_buffer(&parser, buf, len, msgs, 128, NULL), found);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_find),
+    cmocka_unit_test(test_check),
+    cmocka_unit_test(test_scan),
+    cmocka_unit_test(test_scan_matches_parser),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
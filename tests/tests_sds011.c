@@ -7,6 +7,12 @@
 
 #include "../src/sds011.h"
 
+#if SDS011_REQ_QUEUE_MPSC
+#define req_queue_push sds011_mpsc_fifo_push
+#else
+#define req_queue_push sds011_req_ring_push
+#endif
+
 static uint32_t _millis = 0;
 static uint32_t millis_mock(void) {
   return _millis;
@@ -42,6 +48,37 @@ static bool send_byte_mock(uint8_t byte, void *user_data) {
   return true;
 }
 
+static uint32_t _read_calls = 0;
+static uint8_t const *_read_data = NULL;
+static size_t _read_len = 0;
+static size_t read_mock(uint8_t *buf, size_t max, void *user_data) {
+  (void)user_data;
+  size_t len = _read_len < max ? _read_len : max;
+  memcpy(buf, _read_data, len);
+  _read_data += len;
+  _read_len -= len;
+  _read_calls++;
+  return len;
+}
+
+static uint32_t _write_calls = 0;
+static size_t _write_chunk = 0;
+static uint8_t write_buffer[64];
+static size_t write_iter = 0;
+static size_t write_mock(uint8_t const *buf, size_t len, void *user_data) {
+  (void)user_data;
+  _write_calls++;
+  if (len > _write_chunk) {
+    len = _write_chunk;
+  }
+  if (len > sizeof(write_buffer) - write_iter) {
+    len = sizeof(write_buffer) - write_iter;
+  }
+  memcpy(&write_buffer[write_iter], buf, len);
+  write_iter += len;
+  return len;
+}
+
 // helper initialization function
 static void init_sds011(sds011_t *sds011) {
   assert_int_equal(sds011_init(sds011, &(sds011_init_t) {
@@ -142,6 +179,73 @@ static void test_query_data(void **state) {
   assert_int_equal(sds011_process(&sds011), SDS011_OK);
 }
 
+static uint32_t _sample_value_cnt = 0;
+static uint16_t _sample_value_dev_id = 0;
+static sds011_sample_t _sample_value = { 0, 0 };
+static void on_sample_value_callback(uint16_t dev_id, sds011_sample_t sample, void *user_data) {
+  (void)user_data;
+  _sample_value_cnt++;
+  _sample_value_dev_id = dev_id;
+  _sample_value = sample;
+}
+
+static uint32_t _query_cb_call_cnt = 0;
+static void query_callback(sds011_err_t err, sds011_msg_t const *msg, void *user_data) {
+  (void)user_data;
+  assert_int_equal(err, SDS011_OK);
+  assert_int_equal(msg->data.sample.pm10, 2618);
+  _query_cb_call_cnt++;
+}
+
+static void test_sample_value_callback(void **state) {
+  (void) state; /* unused */
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+
+  assert_int_equal(sds011_set_sample_value_callback(
+    NULL, (sds011_on_sample_value_t) { .callback = NULL }), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_set_sample_value_callback(&sds011, (sds011_on_sample_value_t) {
+    .callback = on_sample_value_callback,
+    .user_data = NULL,
+  }), SDS011_OK);
+
+  size_t size = sds011_builder_build(&(sds011_msg_t) {
+    .dev_id             = 0xA160,
+    .type               = SDS011_MSG_TYPE_DATA,
+    .op                 = SDS011_MSG_OP_GET,
+    .src                = SDS011_MSG_SRC_SENSOR,
+    .data.sample.pm2_5  = 1236,
+    .data.sample.pm10   = 2618,
+  }, read_byte_buffer, sizeof(read_byte_buffer));
+
+  // active reporting, message is not decoded
+  _sample_value_cnt = 0;
+  _bytes_available = size;
+  read_byte_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_sample_value_cnt,     1);
+  assert_int_equal(_sample_value_dev_id,  0xA160);
+  assert_int_equal(_sample_value.pm2_5,   1236);
+  assert_int_equal(_sample_value.pm10,    2618);
+
+  // pending query still receives the decoded message
+  send_byte_iter = 0;
+  _send_bytes_available = sizeof(send_byte_buffer);
+  _query_cb_call_cnt = 0;
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t) {
+    .callback = query_callback,
+    .user_data = NULL,
+  }), SDS011_OK);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+
+  _bytes_available = size;
+  read_byte_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_sample_value_cnt,  2);
+  assert_int_equal(_query_cb_call_cnt, 1);
+}
+
 static void test_max_requests(void **state) {
   (void) state; /* unused */
 
@@ -154,6 +258,114 @@ static void test_max_requests(void **state) {
   assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_ERR_BUSY);
 }
 
+static void test_max_requests_while_active(void **state) {
+  (void) state; /* unused */
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+
+  _millis = 0;
+  _bytes_available = 0;
+  send_byte_iter = 0;
+  _send_bytes_available = sizeof(send_byte_buffer);
+
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK); // send
+  assert_int_equal(sds011.req.inflight[0].status, SDS011_REQ_STATUS_RUNNING);
+  assert_int_equal(sds011.req.inflight[0].request.msg.dev_id, 0xA160);
+
+  // running request does not take a queue slot
+  for (int i = 0; i < SDS011_REQ_QUEUE_SIZE; i++) {
+    assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  }
+  assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_ERR_BUSY);
+  assert_int_equal(sds011.req.inflight[0].request.msg.dev_id, 0xA160);
+}
+
+static uint32_t _order_cnt = 0;
+static uint32_t _order[8];
+static void order_cb(sds011_err_t err, sds011_msg_t const *msg, void *user_data) {
+  (void)err;
+  (void)msg;
+  if (_order_cnt < 8) {
+    _order[_order_cnt++] = (uint32_t)(uintptr_t)user_data;
+  }
+}
+
+static void test_priority(void **state) {
+  (void) state; /* unused */
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+
+  _millis = 0;
+  _bytes_available = 0;
+  send_byte_iter = 0;
+  _send_bytes_available = 0;
+  _order_cnt = 0;
+
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)1,
+  }), SDS011_OK);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK); // 1 sent
+
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)2,
+  }), SDS011_OK);
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)3,
+  }), SDS011_OK);
+  assert_int_equal(sds011_set_sleep_on_prio(&sds011, 0xA160, SDS011_REQ_PRIORITY_HIGH, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)4,
+  }), SDS011_OK);
+  assert_int_equal(sds011_set_sleep_off_prio(&sds011, 0xA160, SDS011_REQ_PRIORITY_HIGH, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)5,
+  }), SDS011_OK);
+  assert_int_equal(sds011_get_sleep_prio(&sds011, 0xA160, SDS011_REQ_PRIORITY_COUNT, (sds011_cb_t) {
+    .callback = order_cb, .user_data = (void *)6,
+  }), SDS011_ERR_INVALID_PARAM);
+
+  // running request is not preempted, then high priority requests in order
+  for (uint32_t i = 0; i < 6; i++) {
+    _millis += 2000;
+    assert_int_equal(sds011_process(&sds011), SDS011_OK); // retry
+    _millis += 2000;
+    assert_int_equal(sds011_process(&sds011), SDS011_OK); // timeout, next
+  }
+  assert_int_equal(_order_cnt, 5);
+  assert_int_equal(_order[0], 1);
+  assert_int_equal(_order[1], 4);
+  assert_int_equal(_order[2], 5);
+  assert_int_equal(_order[3], 2);
+  assert_int_equal(_order[4], 3);
+  _millis = 0;
+}
+
+static void test_priority_queue_size(void **state) {
+  (void) state; /* unused */
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+
+  // every priority level has its own capacity
+  for (int i = 0; i < SDS011_REQ_QUEUE_SIZE; i++) {
+    assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  }
+  assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_ERR_BUSY);
+
+  for (int i = 0; i < SDS011_REQ_HIGH_QUEUE_SIZE; i++) {
+    assert_int_equal(sds011_set_sleep_on_prio(&sds011, 0xFFFF, SDS011_REQ_PRIORITY_HIGH, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  }
+  assert_int_equal(sds011_set_sleep_on_prio(&sds011, 0xFFFF, SDS011_REQ_PRIORITY_HIGH, (sds011_cb_t){NULL, NULL}), SDS011_ERR_BUSY);
+
+  // running high priority request does not take a slot
+  _send_bytes_available = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(sds011.req.inflight[0].request.msg.type, SDS011_MSG_TYPE_SLEEP);
+  assert_int_equal(sds011_set_sleep_on_prio(&sds011, 0xFFFF, SDS011_REQ_PRIORITY_HIGH, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  assert_int_equal(sds011_query_data(&sds011, 0xFFFF, (sds011_cb_t){NULL, NULL}), SDS011_ERR_BUSY);
+}
+
 static void test_set_dev_id(void **state) {
   (void) state; /* unused */
 
@@ -635,6 +847,292 @@ static void test_send_timeout(void **state) {
   assert_int_equal(sds011_process(&sds011), SDS011_OK); // send
 }
 
+static uint32_t _send_budget = 0;
+static bool send_byte_budget_mock(uint8_t byte, void *user_data) {
+  (void)user_data;
+  if (_send_budget == 0) {
+    return false;
+  }
+  _send_budget--;
+  if (send_byte_iter < sizeof(send_byte_buffer)) {
+    send_byte_buffer[send_byte_iter++] = byte;
+  }
+  return true;
+}
+
+static void test_send_resumed(void **state) {
+  (void)state;
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+  sds011.cfg.serial.send_byte = send_byte_budget_mock;
+
+  send_byte_iter = 0;
+  _bytes_available = 0;
+  _millis = 0;
+
+  assert_int_equal(sds011_set_sleep_on(&sds011, 0xA160, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+
+  // process returns when the port does not accept more bytes
+  for (uint32_t i = 0; i < 3; i++) {
+    _send_budget = 5;
+    assert_int_equal(sds011_process(&sds011), SDS011_OK);
+    assert_int_equal(send_byte_iter, (i + 1) * 5);
+    assert_int_equal(sds011.req.inflight[0].tx_offset, (i + 1) * 5);
+    assert_int_equal(sds011.req.inflight[0].status, SDS011_REQ_STATUS_RUNNING);
+  }
+  _send_budget = 100;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(send_byte_iter, SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(send_byte_buffer, sds011.req.inflight[0].frame, SDS011_QUERY_PACKET_SIZE);
+
+  // reply timeout once sent, the retry is not accepted by the port
+  _send_budget = 0;
+  send_byte_iter = 0;
+  _millis = 2000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(sds011.req.inflight[0].err, SDS011_ERR_TIMEOUT);
+  assert_int_equal(sds011.req.inflight[0].tx_offset, 0);
+
+  // retry not sent in time
+  _millis = 4000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(sds011.req.inflight[0].err, SDS011_ERR_SEND_DATA);
+  assert_int_equal(sds011.req.inflight[0].status, SDS011_REQ_STATUS_IDLE);
+  assert_int_equal(send_byte_iter, 0);
+  _millis = 0;
+}
+
+static void test_retry_resends_frame(void **state) {
+  (void)state;
+
+  sds011_t sds011;
+  init_sds011(&sds011);
+
+  uint8_t ref[] = {
+    0xAA, 0xB4, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA1, 0x60, 0x08, 0xAB
+  };
+
+  read_byte_iter = 0;
+  _bytes_available = 0;
+  _millis = 0;
+
+  assert_int_equal(sds011_set_sleep_on(&sds011, 0xA160, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+
+  send_byte_iter = 0;
+  _send_bytes_available = sizeof(send_byte_buffer);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK); // send
+  assert_int_equal(send_byte_iter, SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(send_byte_buffer, ref, sizeof(ref));
+  uint8_t const *frame = sds011.req.inflight[0].frame;
+
+  // retry after timeout
+  send_byte_iter = 0;
+  _millis = 2000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(send_byte_iter, SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(send_byte_buffer, ref, sizeof(ref));
+  assert_true(sds011.req.inflight[0].frame == frame);
+
+  // the same request later is served from the cache
+  _millis = 5000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(sds011_set_sleep_on(&sds011, 0xA160, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  send_byte_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_memory_equal(send_byte_buffer, ref, sizeof(ref));
+  assert_true(sds011.req.inflight[0].frame == frame);
+  _millis = 0;
+}
+
+static void test_tx_ring(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  sds011_t sensors[2];
+  sds011_iovec_t const *iov;
+
+  sds011_tx_ring_init(&ring);
+
+  // two sensors on one port
+  for (size_t i = 0; i < 2; i++) {
+    assert_int_equal(sds011_init(&sensors[i], &(sds011_init_t) {
+      .msg_timeout = 1000,
+      .retries = 2,
+      .millis = millis_mock,
+      .serial = {
+        .bytes_available  = bytes_available_mock,
+        .read_byte        = read_byte_mock,
+        .send_byte        = NULL,
+      },
+      .tx_ring = &ring,
+    }), SDS011_OK);
+  }
+
+  _bytes_available = 0;
+  _millis = 0;
+
+  assert_int_equal(sds011_set_sleep_on(&sensors[0], 0xA160, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  assert_int_equal(sds011_query_data(&sensors[1], 0xA161, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  assert_int_equal(sds011_process(&sensors[0]), SDS011_OK);
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK);
+
+  // frames are built into the ring slots
+  uint8_t frame[2][SDS011_QUERY_PACKET_SIZE];
+  assert_int_equal(sds011_builder_build(&sensors[0].req.inflight[0].request.msg,
+                                        frame[0], sizeof(frame[0])), SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(sds011_builder_build(&sensors[1].req.inflight[0].request.msg,
+                                        frame[1], sizeof(frame[1])), SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 2);
+  assert_true(iov[0].iov_base == ring.frames[0]);
+  assert_memory_equal(iov[0].iov_base, frame[0], SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(iov[0].iov_len, SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(iov[1].iov_base, frame[1], SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(iov[1].iov_len, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(((uint8_t const *)iov[0].iov_base)[2], 0x06);
+  assert_int_equal(((uint8_t const *)iov[1].iov_base)[2], 0x04);
+
+  // queued frames are not sent yet
+  assert_int_equal(sensors[0].req.inflight[0].tx_offset, 0);
+  assert_int_equal(sensors[1].req.inflight[0].tx_offset, 0);
+
+  // frame still queued at the timeout, the retry does not queue it again
+  _millis = 2000;
+  assert_int_equal(sds011_process(&sensors[0]), SDS011_OK);
+  assert_int_equal(sensors[0].req.inflight[0].status, SDS011_REQ_STATUS_RUNNING);
+  assert_int_equal(sensors[0].req.inflight[0].retry, 1);
+  assert_int_equal(sensors[0].req.inflight[0].tx_offset, 0);
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 2);
+
+  // the reply timeout starts when the frame is sent
+  _millis = 2500;
+  sds011_tx_ring_consume(&ring, SDS011_QUERY_PACKET_SIZE - 1);
+  assert_int_equal(sds011_process(&sensors[0]), SDS011_OK);
+  assert_int_equal(sensors[0].req.inflight[0].tx_offset, 0);
+  sds011_tx_ring_consume(&ring, 1);
+  assert_int_equal(sds011_process(&sensors[0]), SDS011_OK);
+  assert_int_equal(sensors[0].req.inflight[0].tx_offset, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(sensors[0].req.inflight[0].start_time, 2500);
+  _millis = 3400;
+  assert_int_equal(sds011_process(&sensors[0]), SDS011_OK);
+  assert_int_equal(sensors[0].req.inflight[0].status, SDS011_REQ_STATUS_RUNNING);
+  assert_int_equal(sensors[0].req.inflight[0].retry, 1);
+
+  // frame never sent fails the request, the queued copy stays in the ring
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK); // retry
+  assert_int_equal(sensors[1].req.inflight[0].retry, 1);
+  _millis = 4500;
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK);
+  assert_int_equal(sensors[1].req.inflight[0].err, SDS011_ERR_SEND_DATA);
+  assert_int_equal(sensors[1].req.inflight[0].status, SDS011_REQ_STATUS_IDLE);
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 1);
+
+  // next request queues its own frame, sending the stale copy does not count
+  assert_int_equal(sds011_get_sleep(&sensors[1], 0xA161, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK);
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 2);
+  sds011_tx_ring_consume(&ring, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK);
+  assert_int_equal(sensors[1].req.inflight[0].tx_offset, 0);
+  sds011_tx_ring_consume(&ring, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(sds011_process(&sensors[1]), SDS011_OK);
+  assert_int_equal(sensors[1].req.inflight[0].tx_offset, SDS011_QUERY_PACKET_SIZE);
+  _millis = 0;
+}
+
+static void init_sds011_block(sds011_t *sds011) {
+  assert_int_equal(sds011_init(sds011, &(sds011_init_t) {
+    .msg_timeout = 1000,
+    .retries = 2,
+    .millis = millis_mock,
+    .serial = {
+      .read   = read_mock,
+      .write  = write_mock,
+    },
+  }), SDS011_OK);
+}
+
+static void test_block_serial(void **state) {
+  (void)state;
+
+  sds011_t sds011;
+
+  assert_int_equal(sds011_init(&sds011, &(sds011_init_t) {
+    .millis = millis_mock,
+    .serial = { .read = read_mock },
+  }), SDS011_ERR_INVALID_PARAM);
+  assert_int_equal(sds011_init(&sds011, &(sds011_init_t) {
+    .millis = millis_mock,
+    .serial = { .write = write_mock, .send_byte = send_byte_mock },
+  }), SDS011_ERR_INVALID_PARAM);
+
+  init_sds011_block(&sds011);
+
+  uint8_t stream[SDS011_RX_BLOCK_SIZE + 3 * SDS011_REPLY_PACKET_SIZE];
+  size_t len = 0;
+
+  _millis = 0;
+  _read_len = 0;
+  _read_calls = 0;
+  _write_calls = 0;
+  _write_chunk = 7;
+  write_iter = 0;
+  _sample_value_cnt = 0;
+  _query_cb_call_cnt = 0;
+
+  assert_int_equal(sds011_set_sample_value_callback(&sds011, (sds011_on_sample_value_t) {
+    .callback = on_sample_value_callback,
+  }), SDS011_OK);
+
+  // request written in chunks
+  assert_int_equal(sds011_query_data(&sds011, 0xA160, (sds011_cb_t) {
+    .callback = query_callback,
+  }), SDS011_OK);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(write_iter, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(_write_calls, 3);
+  assert_memory_equal(write_buffer, sds011.req.inflight[0].frame, SDS011_QUERY_PACKET_SIZE);
+  assert_int_equal(_read_calls, 1);
+
+  // more than one block of replies, a reply split between blocks
+  while (len + SDS011_REPLY_PACKET_SIZE <= sizeof(stream)) {
+    len += sds011_builder_build(&(sds011_msg_t) {
+      .dev_id = 0xA160,
+      .type   = SDS011_MSG_TYPE_DATA,
+      .op     = SDS011_MSG_OP_GET,
+      .src    = SDS011_MSG_SRC_SENSOR,
+      .data.sample = { .pm2_5 = (uint16_t)len, .pm10 = 2618 },
+    }, &stream[len], sizeof(stream) - len);
+  }
+
+  _read_calls = 0;
+  _read_data = stream;
+  _read_len = len;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_read_calls, 2);
+  assert_int_equal(_sample_value_cnt, len / SDS011_REPLY_PACKET_SIZE);
+  assert_int_equal(_query_cb_call_cnt, 1);
+
+  // invalid packet is reported, next one processed
+  uint8_t invalid[] = { 0xAA, 0xC5, 0x08, 0x00, 31, 0x00, 0xA1, 0x60, 0x28, 0xAB };
+  memcpy(stream, invalid, sizeof(invalid));
+  len = sizeof(invalid);
+  len += sds011_builder_build(&(sds011_msg_t) {
+    .dev_id = 0xA160,
+    .type   = SDS011_MSG_TYPE_DATA,
+    .op     = SDS011_MSG_OP_GET,
+    .src    = SDS011_MSG_SRC_SENSOR,
+  }, &stream[len], sizeof(stream) - len);
+
+  _sample_value_cnt = 0;
+  _read_data = stream;
+  _read_len = len;
+  assert_int_equal(sds011_process(&sds011), SDS011_ERR_INVALID_DATA);
+  assert_int_equal(_sample_value_cnt, 1);
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+}
+
 static bool _msg_cb_called = false;
 static void msg_cb(sds011_err_t err, sds011_msg_t const *msg, void *user_data) {
   (void)err;
@@ -652,7 +1150,7 @@ static void test_send_invalid_msg(void **state) {
   send_byte_iter = 0;
   _send_bytes_available = sizeof(send_byte_buffer);
 
-  assert_true(sds011_fifo_push(&sds011.req.queue, &(sds011_request_t) {
+  assert_true(req_queue_push(&sds011.req.queue, &(sds011_request_t) {
     .msg = (sds011_msg_t) {
       .dev_id                 = 0xA160,
       .type                   = (sds011_msg_type_t)500,
@@ -729,11 +1227,162 @@ static void test_other_msg_op_during_request(void **state) {
   assert_false(_msg_cb_called);
 }
 
+#if SDS011_REQ_INFLIGHT > 1
+static uint32_t _inflight_cnt = 0;
+static uint32_t _inflight_order[8];
+static sds011_err_t _inflight_err[8];
+static uint16_t _inflight_dev_id[8];
+static void inflight_cb(sds011_err_t err, sds011_msg_t const *msg, void *user_data) {
+  uint32_t i = (uint32_t)(uintptr_t)user_data;
+  _inflight_err[i] = err;
+  _inflight_dev_id[i] = msg ? msg->dev_id : 0;
+  if (_inflight_cnt < 8) {
+    _inflight_order[_inflight_cnt++] = i;
+  }
+}
+
+static size_t build_data_reply(uint8_t *buf, size_t size, uint16_t dev_id) {
+  return sds011_builder_build(&(sds011_msg_t) {
+    .dev_id = dev_id,
+    .type   = SDS011_MSG_TYPE_DATA,
+    .op     = SDS011_MSG_OP_GET,
+    .src    = SDS011_MSG_SRC_SENSOR,
+  }, buf, size);
+}
+
+static void test_inflight_pipelined(void **state) {
+  (void)state;
+
+  sds011_t sds011;
+  init_sds011_block(&sds011);
+
+  uint8_t stream[2 * SDS011_REPLY_PACKET_SIZE];
+  size_t len = 0;
+
+  _millis = 0;
+  _read_len = 0;
+  _write_chunk = sizeof(write_buffer);
+  write_iter = 0;
+  _inflight_cnt = 0;
+
+  // queries to different devices are sent without waiting for replies
+  for (uint32_t i = 0; i < 3; i++) {
+    assert_int_equal(sds011_query_data(&sds011, (uint16_t)(0xA001 + i), (sds011_cb_t) {
+      .callback = inflight_cb, .user_data = (void *)(uintptr_t)i,
+    }), SDS011_OK);
+  }
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(write_iter, 3 * SDS011_QUERY_PACKET_SIZE);
+  for (uint32_t i = 0; i < 3; i++) {
+    assert_int_equal(sds011.req.inflight[i].status, SDS011_REQ_STATUS_RUNNING);
+    assert_memory_equal(&write_buffer[i * SDS011_QUERY_PACKET_SIZE],
+                        sds011.req.inflight[i].frame, SDS011_QUERY_PACKET_SIZE);
+  }
+
+  // replies are matched by device id, in any order
+  len += build_data_reply(&stream[len], sizeof(stream) - len, 0xA003);
+  len += build_data_reply(&stream[len], sizeof(stream) - len, 0xA001);
+  _read_data = stream;
+  _read_len = len;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_inflight_cnt, 2);
+  assert_int_equal(_inflight_order[0], 0);
+  assert_int_equal(_inflight_order[1], 2);
+  assert_int_equal(_inflight_err[0], SDS011_OK);
+  assert_int_equal(_inflight_dev_id[0], 0xA001);
+  assert_int_equal(_inflight_err[2], SDS011_OK);
+  assert_int_equal(_inflight_dev_id[2], 0xA003);
+
+  // every request has its own timeout and retry count
+  write_iter = 0;
+  _millis = 2000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(sds011.req.inflight[1].retry, 1);
+  assert_int_equal(write_iter, SDS011_QUERY_PACKET_SIZE);
+  assert_memory_equal(write_buffer, sds011.req.inflight[1].frame, SDS011_QUERY_PACKET_SIZE);
+
+  _millis = 4000;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_inflight_cnt, 3);
+  assert_int_equal(_inflight_err[1], SDS011_ERR_TIMEOUT);
+  for (uint32_t i = 0; i < SDS011_REQ_INFLIGHT; i++) {
+    assert_int_equal(sds011.req.inflight[i].status, SDS011_REQ_STATUS_IDLE);
+  }
+  _millis = 0;
+}
+
+static void test_inflight_same_device(void **state) {
+  (void)state;
+
+  sds011_t sds011;
+  init_sds011_block(&sds011);
+
+  uint8_t stream[2 * SDS011_REPLY_PACKET_SIZE];
+  size_t len = 0;
+
+  _millis = 0;
+  _read_len = 0;
+  _write_chunk = sizeof(write_buffer);
+  write_iter = 0;
+  _inflight_cnt = 0;
+
+  uint16_t const dev_ids[] = { 0xA001, 0xA001, 0xA002, 0xFFFF };
+  for (uint32_t i = 0; i < 4; i++) {
+    assert_int_equal(sds011_query_data(&sds011, dev_ids[i], (sds011_cb_t) {
+      .callback = inflight_cb, .user_data = (void *)(uintptr_t)i,
+    }), SDS011_OK);
+  }
+
+  // second request to the same device waits, the requests behind it too
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(write_iter, SDS011_QUERY_PACKET_SIZE);
+
+  // broadcast waits until the other requests are completed
+  len = build_data_reply(stream, sizeof(stream), 0xA001);
+  _read_data = stream;
+  _read_len = len;
+  write_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_inflight_cnt, 1);
+  assert_int_equal(write_iter, 2 * SDS011_QUERY_PACKET_SIZE);
+
+  len  = build_data_reply(stream, sizeof(stream), 0xA002);
+  len += build_data_reply(&stream[len], sizeof(stream) - len, 0xA001);
+  _read_data = stream;
+  _read_len = len;
+  write_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_inflight_cnt, 3);
+  assert_int_equal(_inflight_dev_id[1], 0xA001);
+  assert_int_equal(_inflight_dev_id[2], 0xA002);
+  assert_int_equal(write_iter, SDS011_QUERY_PACKET_SIZE);
+
+  // nothing runs next to the broadcast
+  assert_int_equal(sds011_query_data(&sds011, 0xA003, (sds011_cb_t){NULL, NULL}), SDS011_OK);
+  write_iter = 0;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(write_iter, 0);
+
+  len = build_data_reply(stream, sizeof(stream), 0xA002);
+  _read_data = stream;
+  _read_len = len;
+  assert_int_equal(sds011_process(&sds011), SDS011_OK);
+  assert_int_equal(_inflight_cnt, 4);
+  assert_int_equal(_inflight_err[3], SDS011_OK);
+  assert_int_equal(_inflight_dev_id[3], 0xA002);
+  assert_int_equal(write_iter, SDS011_QUERY_PACKET_SIZE);
+}
+#endif
+
 int main(void) {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_init),
     cmocka_unit_test(test_query_data),
+    cmocka_unit_test(test_sample_value_callback),
     cmocka_unit_test(test_max_requests),
+    cmocka_unit_test(test_max_requests_while_active),
+    cmocka_unit_test(test_priority),
+    cmocka_unit_test(test_priority_queue_size),
     cmocka_unit_test(test_set_dev_id),
     cmocka_unit_test(test_set_reporting_active),
     cmocka_unit_test(test_set_reporting_query),
@@ -755,8 +1404,16 @@ int main(void) {
     cmocka_unit_test(test_infinite_send_timeout),
     cmocka_unit_test(test_send_timeout),
     cmocka_unit_test(test_send_invalid_msg),
+    cmocka_unit_test(test_retry_resends_frame),
+    cmocka_unit_test(test_send_resumed),
+    cmocka_unit_test(test_tx_ring),
+    cmocka_unit_test(test_block_serial),
     cmocka_unit_test(test_other_msg_type_during_request),
     cmocka_unit_test(test_other_msg_op_during_request),
+#if SDS011_REQ_INFLIGHT > 1
+    cmocka_unit_test(test_inflight_pipelined),
+    cmocka_unit_test(test_inflight_same_device),
+#endif
   };
   return cmocka_run_group_tests(tests, NULL, NULL);
 }
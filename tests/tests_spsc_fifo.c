@@ -0,0 +1,146 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../src/sds011_spsc_fifo.h"
+
+#define TRANSFER_COUNT (1000 * 1000)
+
+static void test_spsc_init_params(void **state) {
+  (void)state;
+
+  sds011_spsc_fifo_t fifo;
+  uint8_t mem[4];
+
+  assert_false(sds011_spsc_fifo_init(NULL, 1, mem, sizeof(mem)));
+  assert_false(sds011_spsc_fifo_init(&fifo, 0, mem, sizeof(mem)));
+  assert_false(sds011_spsc_fifo_init(&fifo, 1, NULL, sizeof(mem)));
+  assert_false(sds011_spsc_fifo_init(&fifo, 1, mem, 0));
+  assert_false(sds011_spsc_fifo_init(&fifo, 8, mem, sizeof(mem)));
+  assert_true (sds011_spsc_fifo_init(&fifo, 2, mem, sizeof(mem)));
+  assert_int_equal(fifo.count, 2);
+
+  uint8_t el[2] = { 0 };
+  assert_false(sds011_spsc_fifo_push(NULL, el));
+  assert_false(sds011_spsc_fifo_push(&fifo, NULL));
+  assert_false(sds011_spsc_fifo_pop(NULL, el));
+  assert_false(sds011_spsc_fifo_pop(&fifo, NULL));
+  assert_int_equal(sds011_spsc_fifo_push_n(NULL, el, 1), 0);
+  assert_int_equal(sds011_spsc_fifo_pop_n(&fifo, NULL, 1), 0);
+}
+
+static void test_spsc_push_pop(void **state) {
+  (void)state;
+
+  sds011_spsc_fifo_t fifo;
+  uint32_t mem[4];
+  uint32_t el;
+
+  assert_true(sds011_spsc_fifo_init(&fifo, sizeof(uint32_t), mem, sizeof(mem)));
+  assert_false(sds011_spsc_fifo_pop(&fifo, &el));
+
+  // one slot is kept unused
+  for (uint32_t round = 0; round < 5; round++) {
+    for (uint32_t i = 0; i < 3; i++) {
+      el = round * 10 + i;
+      assert_true(sds011_spsc_fifo_push(&fifo, &el));
+    }
+    assert_false(sds011_spsc_fifo_push(&fifo, &el));
+
+    for (uint32_t i = 0; i < 3; i++) {
+      assert_true(sds011_spsc_fifo_pop(&fifo, &el));
+      assert_int_equal(el, round * 10 + i);
+    }
+    assert_false(sds011_spsc_fifo_pop(&fifo, &el));
+  }
+}
+
+static void test_spsc_push_pop_n(void **state) {
+  (void)state;
+
+  sds011_spsc_fifo_t fifo;
+  uint8_t mem[8];
+  uint8_t in[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  uint8_t out[10];
+
+  assert_true(sds011_spsc_fifo_init(&fifo, 1, mem, sizeof(mem)));
+
+  assert_int_equal(sds011_spsc_fifo_push_n(&fifo, in, 5), 5);
+  assert_int_equal(sds011_spsc_fifo_pop_n(&fifo, out, 3), 3);
+  assert_memory_equal(out, in, 3);
+
+  // wraps around, limited by free slots
+  assert_int_equal(sds011_spsc_fifo_push_n(&fifo, in + 5, 5), 5);
+  assert_int_equal(sds011_spsc_fifo_push_n(&fifo, in, 1), 0);
+  assert_int_equal(sds011_spsc_fifo_pop_n(&fifo, out, sizeof(out)), 7);
+  assert_memory_equal(out, in + 3, 7);
+  assert_int_equal(sds011_spsc_fifo_pop_n(&fifo, out, sizeof(out)), 0);
+}
+
+typedef struct {
+  uint32_t seq;
+  uint32_t check;
+} item_t;
+
+static sds011_spsc_fifo_t thread_fifo;
+static item_t thread_mem[64];
+
+static void *producer(void *arg) {
+  (void)arg;
+  for (uint32_t i = 0; i < TRANSFER_COUNT; ) {
+    item_t items[4];
+    size_t n = 0;
+    for (; n < 4 && i + n < TRANSFER_COUNT; n++) {
+      items[n] = (item_t) { .seq = i + (uint32_t)n, .check = ~(i + (uint32_t)n) };
+    }
+    size_t pushed = (i % 2) ? sds011_spsc_fifo_push_n(&thread_fifo, items, n)
+                            : (size_t)sds011_spsc_fifo_push(&thread_fifo, &items[0]);
+    if (pushed == 0) {
+      sched_yield();
+    }
+    i += (uint32_t)pushed;
+  }
+  return NULL;
+}
+
+// Elements pushed by one thread are received by the other one complete
+// and in order.
+static void test_spsc_threads(void **state) {
+  (void)state;
+
+  pthread_t thread;
+  uint32_t expected = 0;
+  size_t errors = 0;
+
+  assert_true(sds011_spsc_fifo_init(&thread_fifo, sizeof(item_t), thread_mem, sizeof(thread_mem)));
+  assert_int_equal(pthread_create(&thread, NULL, producer, NULL), 0);
+
+  while (expected < TRANSFER_COUNT) {
+    item_t items[8];
+    size_t n = sds011_spsc_fifo_pop_n(&thread_fifo, items, 8);
+    if (n == 0) {
+      sched_yield();
+    }
+    for (size_t i = 0; i < n; i++, expected++) {
+      errors += (items[i].seq != expected || items[i].check != ~expected) ? 1 : 0;
+    }
+  }
+
+  assert_int_equal(pthread_join(thread, NULL), 0);
+  assert_int_equal(errors, 0);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_spsc_init_params),
+    cmocka_unit_test(test_spsc_push_pop),
+    cmocka_unit_test(test_spsc_push_pop_n),
+    cmocka_unit_test(test_spsc_threads),
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
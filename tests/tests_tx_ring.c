@@ -0,0 +1,216 @@
+/*lint -e818*/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/sds011_tx_ring.h"
+
+static uint8_t const frame_a[] = { 0xAA, 0xB4, 0x02, 0xAB };
+static uint8_t const frame_b[] = { 0xAA, 0xC0, 0x01, 0x02, 0xAB };
+
+static void test_tx_ring_init(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  sds011_iovec_t const *iov;
+
+  sds011_tx_ring_init(NULL);
+  sds011_tx_ring_init(&ring);
+
+  assert_true(sds011_tx_ring_is_empty(&ring));
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 0);
+  assert_int_equal(sds011_tx_ring_peek(NULL, &iov), 0);
+  assert_int_equal(sds011_tx_ring_peek(&ring, NULL), 0);
+
+  assert_false(sds011_tx_ring_push(NULL, frame_a, sizeof(frame_a)));
+  assert_false(sds011_tx_ring_push(&ring, NULL, sizeof(frame_a)));
+  assert_false(sds011_tx_ring_push(&ring, frame_a, 0));
+  assert_false(sds011_tx_ring_push(&ring, frame_a, SDS011_QUERY_PACKET_SIZE + 1));
+  assert_true(sds011_tx_ring_is_empty(&ring));
+}
+
+static void test_tx_ring_push_consume(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  sds011_iovec_t const *iov;
+  uint8_t buf[sizeof(frame_a)];
+
+  sds011_tx_ring_init(&ring);
+
+  memcpy(buf, frame_a, sizeof(frame_a));
+  assert_true(sds011_tx_ring_push(&ring, buf, sizeof(buf)));
+  assert_true(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+  assert_false(sds011_tx_ring_is_empty(&ring));
+
+  // frames are copied, the sender buffer can be reused
+  memset(buf, 0, sizeof(buf));
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 2);
+  assert_true(iov[0].iov_base == ring.frames[0]);
+  assert_memory_equal(iov[0].iov_base, frame_a, sizeof(frame_a));
+  assert_int_equal(iov[0].iov_len, sizeof(frame_a));
+  assert_memory_equal(iov[1].iov_base, frame_b, sizeof(frame_b));
+  assert_int_equal(iov[1].iov_len, sizeof(frame_b));
+
+  // partial write
+  sds011_tx_ring_consume(&ring, sizeof(frame_a) + 2);
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 1);
+  assert_true(iov[0].iov_base == ring.frames[1] + 2);
+  assert_int_equal(iov[0].iov_len, sizeof(frame_b) - 2);
+
+  sds011_tx_ring_consume(&ring, 100);
+  assert_true(sds011_tx_ring_is_empty(&ring));
+  sds011_tx_ring_consume(NULL, 1);
+}
+
+static void test_tx_ring_full_and_wrap(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  sds011_iovec_t const *iov;
+
+  sds011_tx_ring_init(&ring);
+
+  for (size_t i = 0; i < SDS011_TX_RING_SIZE; i++) {
+    assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  }
+  assert_false(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+
+  sds011_tx_ring_consume(&ring, 3 * sizeof(frame_a));
+  for (size_t i = 0; i < 3; i++) {
+    assert_true(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+  }
+  assert_false(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+
+  // contiguous run up to the end of the ring, then the wrapped slots
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), SDS011_TX_RING_SIZE - 3);
+  sds011_tx_ring_consume(&ring, (SDS011_TX_RING_SIZE - 3) * sizeof(frame_a));
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 3);
+  assert_memory_equal(iov[2].iov_base, frame_b, sizeof(frame_b));
+}
+
+static void test_tx_ring_reserve_commit(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  sds011_iovec_t const *iov;
+
+  sds011_tx_ring_init(&ring);
+  assert_null(sds011_tx_ring_reserve(NULL));
+  assert_false(sds011_tx_ring_commit(NULL, sizeof(frame_a)));
+
+  // frame written straight into the slot
+  uint8_t *frame = sds011_tx_ring_reserve(&ring);
+  assert_true(frame == ring.frames[0]);
+  memcpy(frame, frame_a, sizeof(frame_a));
+  assert_true(sds011_tx_ring_is_empty(&ring));
+  assert_false(sds011_tx_ring_commit(&ring, 0));
+  assert_false(sds011_tx_ring_commit(&ring, SDS011_QUERY_PACKET_SIZE + 1));
+  assert_true(sds011_tx_ring_commit(&ring, sizeof(frame_a)));
+  assert_int_equal(sds011_tx_ring_last(&ring), 1);
+
+  assert_int_equal(sds011_tx_ring_peek(&ring, &iov), 1);
+  assert_true(iov[0].iov_base == frame);
+  assert_int_equal(iov[0].iov_len, sizeof(frame_a));
+
+  for (size_t i = 1; i < SDS011_TX_RING_SIZE; i++) {
+    assert_non_null(sds011_tx_ring_reserve(&ring));
+    assert_true(sds011_tx_ring_commit(&ring, sizeof(frame_b)));
+  }
+  assert_null(sds011_tx_ring_reserve(&ring));
+  assert_false(sds011_tx_ring_commit(&ring, sizeof(frame_b)));
+}
+
+static void test_tx_ring_is_sent(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+
+  sds011_tx_ring_init(&ring);
+  assert_int_equal(sds011_tx_ring_last(&ring), 0);
+
+  assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  uint32_t seq_a = sds011_tx_ring_last(&ring);
+  assert_true(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+  uint32_t seq_b = sds011_tx_ring_last(&ring);
+  assert_int_not_equal(seq_a, seq_b);
+  assert_false(sds011_tx_ring_is_sent(&ring, seq_a));
+  assert_false(sds011_tx_ring_is_sent(&ring, seq_b));
+
+  // partially sent frame is pending
+  sds011_tx_ring_consume(&ring, sizeof(frame_a) - 1);
+  assert_false(sds011_tx_ring_is_sent(&ring, seq_a));
+  sds011_tx_ring_consume(&ring, 1);
+  assert_true(sds011_tx_ring_is_sent(&ring, seq_a));
+  assert_false(sds011_tx_ring_is_sent(&ring, seq_b));
+  sds011_tx_ring_consume(&ring, sizeof(frame_b));
+  assert_true(sds011_tx_ring_is_sent(&ring, seq_b));
+
+  // frame numbers wrap around
+  ring.pushed = UINT32_MAX;
+  assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  seq_a = sds011_tx_ring_last(&ring);
+  assert_int_equal(seq_a, 0);
+  assert_false(sds011_tx_ring_is_sent(&ring, seq_a));
+  assert_true(sds011_tx_ring_is_sent(&ring, UINT32_MAX));
+  sds011_tx_ring_consume(&ring, sizeof(frame_a));
+  assert_true(sds011_tx_ring_is_sent(&ring, seq_a));
+
+  assert_int_equal(sds011_tx_ring_last(NULL), 0);
+  assert_true(sds011_tx_ring_is_sent(NULL, 0));
+}
+
+#ifdef SDS011_TX_RING_POSIX
+static void test_tx_ring_writev(void **state) {
+  (void)state;
+
+  sds011_tx_ring_t ring;
+  int fds[2];
+  uint8_t out[64];
+
+  assert_int_equal(pipe(fds), 0);
+  sds011_tx_ring_init(&ring);
+
+  // wrap around the end of the ring
+  for (size_t i = 0; i < SDS011_TX_RING_SIZE - 1; i++) {
+    assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  }
+  sds011_tx_ring_consume(&ring, (SDS011_TX_RING_SIZE - 1) * sizeof(frame_a));
+
+  assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  assert_true(sds011_tx_ring_push(&ring, frame_b, sizeof(frame_b)));
+
+  assert_int_equal(sds011_tx_ring_writev(&ring, fds[1]), sizeof(frame_a) + sizeof(frame_b));
+  assert_true(sds011_tx_ring_is_empty(&ring));
+  assert_int_equal(sds011_tx_ring_writev(&ring, fds[1]), 0);
+
+  assert_int_equal(read(fds[0], out, sizeof(out)), sizeof(frame_a) + sizeof(frame_b));
+  assert_memory_equal(out, frame_a, sizeof(frame_a));
+  assert_memory_equal(out + sizeof(frame_a), frame_b, sizeof(frame_b));
+
+  // write error, frames stay queued
+  assert_true(sds011_tx_ring_push(&ring, frame_a, sizeof(frame_a)));
+  close(fds[0]);
+  close(fds[1]);
+  assert_int_equal(sds011_tx_ring_writev(&ring, fds[1]), -1);
+  assert_false(sds011_tx_ring_is_empty(&ring));
+  assert_int_equal(sds011_tx_ring_writev(NULL, fds[1]), -1);
+}
+#endif
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_tx_ring_init),
+    cmocka_unit_test(test_tx_ring_push_consume),
+    cmocka_unit_test(test_tx_ring_full_and_wrap),
+    cmocka_unit_test(test_tx_ring_reserve_commit),
+    cmocka_unit_test(test_tx_ring_is_sent),
+#ifdef SDS011_TX_RING_POSIX
+    cmocka_unit_test(test_tx_ring_writev),
+#endif
+  };
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
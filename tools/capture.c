@@ -0,0 +1,50 @@
+#include "sds011_capture.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void usage(char const *name) {
+  fprintf(stderr, "usage: %s [-j threads] <capture file>\n", name);
+  fprintf(stderr, "Prints samples found in the raw capture as CSV, grouped by device.\n");
+}
+
+int main(int argc, char *argv[]) {
+  unsigned threads = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:h")) != -1) {
+    switch (opt) {
+      case 'j':
+        threads = (unsigned)strtoul(optarg, NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  sds011_capture_t capture;
+  sds011_err_t err_code = sds011_capture_parse_file(argv[optind], threads, &capture);
+  if (err_code != SDS011_OK) {
+    fprintf(stderr, "Error: %d\n", err_code);
+    return 1;
+  }
+
+  sds011_capture_sort_by_device(&capture);
+
+  printf("dev_id,offset,pm2_5,pm10\n");
+  for (size_t i = 0; i < capture.count; i++) {
+    sds011_capture_sample_t const *s = &capture.samples[i];
+    printf("%04X,%" PRIu64 ",%.1f,%.1f\n", s->dev_id, s->offset,
+      s->sample.pm2_5 / 10.0F, s->sample.pm10 / 10.0F);
+  }
+
+  sds011_capture_free(&capture);
+  return 0;
+}
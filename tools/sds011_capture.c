@@ -0,0 +1,266 @@
+#include "sds011_capture.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../src/sds011_parser.h"
+#include "../src/sds011_scanner.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+#define CAPTURE_MAX_THREADS 256
+#define CAPTURE_MIN_CHUNK   (64 * 1024)
+
+typedef struct {
+  uint8_t const *buf;
+  size_t len;
+  size_t beg, end;
+
+  sds011_capture_sample_t *samples;
+  size_t count;
+  size_t capacity;
+  sds011_err_t err;
+} capture_chunk_t;
+
+// Offset of the first valid packet at or after the offset
+static size_t next_packet(uint8_t const *buf, size_t len, size_t offset) {
+  while (offset < len) {
+    offset += sds011_scanner_find(&buf[offset], len - offset);
+    if (offset >= len) {
+      break;
+    }
+    if (sds011_scanner_check(&buf[offset], len - offset) == SDS011_OK) {
+      return offset;
+    }
+    offset++;
+  }
+  return len;
+}
+
+static bool append_sample(capture_chunk_t *chunk, size_t offset, sds011_msg_t const *msg) {
+  if (chunk->count >= chunk->capacity) {
+    size_t capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+    sds011_capture_sample_t *samples = realloc(chunk->samples, capacity * sizeof(*samples));
+    if (samples == NULL) {
+      return false;
+    }
+    chunk->samples = samples;
+    chunk->capacity = capacity;
+  }
+
+  chunk->samples[chunk->count++] = (sds011_capture_sample_t) {
+    .offset = offset,
+    .dev_id = msg->dev_id,
+    .sample = msg->data.sample,
+  };
+  return true;
+}
+
+static void *parse_chunk(void *arg) {
+  capture_chunk_t *chunk = arg;
+
+  sds011_parser_t parser;
+  sds011_parser_init(&parser);
+  sds011_parser_set_resync(&parser, true);
+
+  size_t iter = chunk->beg;
+  size_t limit = chunk->end;
+
+  while (iter < limit) {
+    sds011_msg_t msg;
+    size_t consumed;
+
+    size_t ready = sds011_parser_parse_buffer(
+      &parser, &chunk->buf[iter], limit - iter, &msg, 1, &consumed);
+    iter += consumed;
+
+    if (ready > 0) {
+      size_t size = (msg.src == SDS011_MSG_SRC_HOST) ?
+        SDS011_QUERY_PACKET_SIZE : SDS011_REPLY_PACKET_SIZE;
+      size_t offset = iter - sds011_parser_get_frame_tail(&parser) - size;
+
+      if (offset >= chunk->end) {
+        break; // packet belongs to the next chunk
+      }
+      if (msg.type == SDS011_MSG_TYPE_DATA && msg.src == SDS011_MSG_SRC_SENSOR) {
+        if (append_sample(chunk, offset, &msg) == false) {
+          chunk->err = SDS011_ERR_MEM;
+          break;
+        }
+      }
+    }
+
+    // complete the packet crossing the end of the chunk
+    if (iter >= chunk->end) {
+      if (parser.state == 0) {
+        break;
+      }
+      limit = MIN(chunk->len, chunk->end + SDS011_QUERY_PACKET_SIZE);
+    }
+  }
+
+  return NULL;
+}
+
+static unsigned threads_count(unsigned threads, size_t len) {
+  if (threads == 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cores > 0 ? (unsigned)cores : 1;
+  }
+  threads = MIN(threads, CAPTURE_MAX_THREADS);
+  threads = (unsigned)MIN((size_t)threads, len / CAPTURE_MIN_CHUNK + 1);
+  return threads;
+}
+
+sds011_err_t sds011_capture_parse(uint8_t const *buf, size_t len, unsigned threads,
+                                  sds011_capture_t *capture) {
+  if (capture == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  if (buf == NULL && len > 0) { return SDS011_ERR_INVALID_PARAM; }
+
+  capture->samples = NULL;
+  capture->count = 0;
+
+  threads = threads_count(threads, len);
+
+  capture_chunk_t *chunks = calloc(threads, sizeof(capture_chunk_t));
+  pthread_t *ids = calloc(threads, sizeof(pthread_t));
+  bool *started = calloc(threads, sizeof(bool));
+  if (chunks == NULL || ids == NULL || started == NULL) {
+    free(chunks);
+    free(ids);
+    free(started);
+    return SDS011_ERR_MEM;
+  }
+
+  size_t beg = 0;
+  for (unsigned i = 0; i < threads; i++) {
+    size_t end = len;
+    if (i + 1 < threads) {
+      size_t split = (size_t)((uint64_t)len * (i + 1) / threads);
+      end = next_packet(buf, len, split > beg ? split : beg);
+    }
+    chunks[i] = (capture_chunk_t) {
+      .buf = buf,
+      .len = len,
+      .beg = beg,
+      .end = end,
+      .err = SDS011_OK,
+    };
+    beg = end;
+  }
+
+  for (unsigned i = 1; i < threads; i++) {
+    started[i] = pthread_create(&ids[i], NULL, parse_chunk, &chunks[i]) == 0;
+  }
+  parse_chunk(&chunks[0]);
+  for (unsigned i = 1; i < threads; i++) {
+    if (started[i]) {
+      pthread_join(ids[i], NULL);
+    } else {
+      parse_chunk(&chunks[i]);
+    }
+  }
+
+  sds011_err_t err = SDS011_OK;
+  size_t count = 0;
+  for (unsigned i = 0; i < threads; i++) {
+    if (chunks[i].err != SDS011_OK) {
+      err = chunks[i].err;
+    }
+    count += chunks[i].count;
+  }
+
+  if (err == SDS011_OK && count > 0) {
+    capture->samples = malloc(count * sizeof(sds011_capture_sample_t));
+    if (capture->samples == NULL) {
+      err = SDS011_ERR_MEM;
+    }
+  }
+  if (err == SDS011_OK) {
+    for (unsigned i = 0; i < threads; i++) {
+      if (chunks[i].count > 0) {
+        memcpy(&capture->samples[capture->count], chunks[i].samples,
+          chunks[i].count * sizeof(sds011_capture_sample_t));
+      }
+      capture->count += chunks[i].count;
+    }
+  }
+
+  for (unsigned i = 0; i < threads; i++) {
+    free(chunks[i].samples);
+  }
+  free(chunks);
+  free(ids);
+  free(started);
+
+  return err;
+}
+
+sds011_err_t sds011_capture_parse_file(char const *path, unsigned threads,
+                                       sds011_capture_t *capture) {
+  if (path == NULL || capture == NULL) { return SDS011_ERR_INVALID_PARAM; }
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return SDS011_ERR_INVALID_PARAM;
+  }
+
+  size_t len = (size_t)st.st_size;
+  if (len == 0) {
+    close(fd);
+    return sds011_capture_parse(NULL, 0, threads, capture);
+  }
+
+  void *buf = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED) {
+    return SDS011_ERR_MEM;
+  }
+  madvise(buf, len, MADV_SEQUENTIAL);
+
+  sds011_err_t err = sds011_capture_parse(buf, len, threads, capture);
+
+  munmap(buf, len);
+  return err;
+}
+
+static int compare_samples(void const *a, void const *b) {
+  sds011_capture_sample_t const *sa = a;
+  sds011_capture_sample_t const *sb = b;
+
+  if (sa->dev_id != sb->dev_id) {
+    return sa->dev_id < sb->dev_id ? -1 : 1;
+  }
+  if (sa->offset != sb->offset) {
+    return sa->offset < sb->offset ? -1 : 1;
+  }
+  return 0;
+}
+
+void sds011_capture_sort_by_device(sds011_capture_t *capture) {
+  if (capture == NULL || capture->count == 0) {
+    return;
+  }
+  qsort(capture->samples, capture->count, sizeof(sds011_capture_sample_t), compare_samples);
+}
+
+void sds011_capture_free(sds011_capture_t *capture) {
+  if (capture == NULL) {
+    return;
+  }
+  free(capture->samples);
+  capture->samples = NULL;
+  capture->count = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SDS011_CAPTURE_H__
+#define SDS011_CAPTURE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/sds011_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  uint64_t offset;  // offset of the packet in the capture
+  uint16_t dev_id;
+  sds011_sample_t sample;
+} sds011_capture_sample_t;
+
+typedef struct {
+  sds011_capture_sample_t *samples;
+  size_t count;
+} sds011_capture_t;
+
+/**
+ * @brief Parse raw capture in parallel.
+ *        The capture is split into chunks starting at valid packets, each
+ *        chunk is parsed by a separate thread. A packet crossing the end
+ *        of a chunk is completed by the thread which started it.
+ *        Samples are returned in capture order.
+ * @param[in]  buf raw capture
+ * @param[in]  len size of the capture
+ * @param[in]  threads number of threads, 0 to use all cores
+ * @param[out] capture parsed samples, release with sds011_capture_free
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_capture_parse(uint8_t const *buf, size_t len, unsigned threads,
+                                  sds011_capture_t *capture);
+
+/**
+ * @brief Memory map and parse raw capture file.
+ * @param[in]  path capture file path
+ * @param[in]  threads number of threads, 0 to use all cores
+ * @param[out] capture parsed samples, release with sds011_capture_free
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_capture_parse_file(char const *path, unsigned threads,
+                                       sds011_capture_t *capture);
+
+/**
+ * @brief Group samples into per device streams.
+ *        Samples are sorted by device id, samples of the same device are
+ *        kept in capture order.
+ * @param[in] capture parsed samples
+ */
+void sds011_capture_sort_by_device(sds011_capture_t *capture);
+
+/**
+ * Release parsed samples
+ * @param[in] capture parsed samples
+ */
+void sds011_capture_free(sds011_capture_t *capture);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_CAPTURE_H__
@@ -0,0 +1,145 @@
+#include "sds011_generator.h"
+#include "../src/sds011_builder.h"
+
+#include <string.h>
+
+#define RATE_SCALE  1000000u
+#define PM_MAX      9999        // 999.9 ug/m3, sensor range
+
+sds011_err_t sds011_generator_init(sds011_generator_t *gen, sds011_generator_cfg_t const *cfg) {
+  if (gen == NULL || cfg == NULL) { return SDS011_ERR_INVALID_PARAM; }
+  if (cfg->dev_count == 0 || cfg->dev_count > 0x10000) { return SDS011_ERR_INVALID_PARAM; }
+  if (cfg->pm_dist == SDS011_GENERATOR_PM_UNIFORM && cfg->pm_min > cfg->pm_max) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+  if (cfg->pm_dist != SDS011_GENERATOR_PM_UNIFORM && cfg->pm_dist != SDS011_GENERATOR_PM_NORMAL) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+  if (cfg->reply_rate > RATE_SCALE || cfg->corrupt_rate > RATE_SCALE) {
+    return SDS011_ERR_INVALID_PARAM;
+  }
+
+  gen->cfg = *cfg;
+  gen->rng = cfg->seed != 0 ? cfg->seed : 0x9E3779B97F4A7C15u;
+  memset(&gen->stats, 0, sizeof(gen->stats));
+
+  return SDS011_OK;
+}
+
+// xorshift64*
+static inline uint32_t rng_next(sds011_generator_t *gen) {
+  gen->rng ^= gen->rng >> 12;
+  gen->rng ^= gen->rng << 25;
+  gen->rng ^= gen->rng >> 27;
+  return (uint32_t)((gen->rng * 0x2545F4914F6CDD1Du) >> 32);
+}
+
+static inline uint32_t rng_range(sds011_generator_t *gen, uint32_t range) {
+  return (uint32_t)(((uint64_t)rng_next(gen) * range) >> 32);
+}
+
+static inline uint16_t clamp_pm(int32_t value) {
+  if (value < 0) {
+    return 0;
+  }
+  return value > PM_MAX ? PM_MAX : (uint16_t)value;
+}
+
+// The normal distribution is approximated with the sum of four uniform
+// values (Irwin-Hall), which needs no floating point math.
+static uint16_t random_pm(sds011_generator_t *gen) {
+  sds011_generator_cfg_t const *cfg = &gen->cfg;
+
+  if (cfg->pm_dist == SDS011_GENERATOR_PM_UNIFORM) {
+    return clamp_pm((int32_t)cfg->pm_min + (int32_t)rng_range(gen, cfg->pm_max - cfg->pm_min + 1u));
+  }
+
+  int32_t sum = 0;
+  for (int i = 0; i < 4; i++) {
+    sum += (int32_t)(rng_next(gen) >> 16);
+  }
+  // sum of 4 uniform [0, 65536) values: mean 131072, stddev 37837
+  int32_t dev = (int32_t)(((int64_t)(sum - 131072) * cfg->pm_stddev) / 37837);
+  return clamp_pm((int32_t)cfg->pm_mean + dev);
+}
+
+static void random_msg(sds011_generator_t *gen, sds011_msg_t *msg) {
+  msg->dev_id = (uint16_t)(gen->cfg.dev_id_base + rng_range(gen, gen->cfg.dev_count));
+  msg->src = SDS011_MSG_SRC_SENSOR;
+
+  if (rng_range(gen, RATE_SCALE) >= gen->cfg.reply_rate) {
+    uint16_t pm2_5 = random_pm(gen);
+    msg->type = SDS011_MSG_TYPE_DATA;
+    msg->op = SDS011_MSG_OP_GET;
+    msg->data.sample.pm2_5 = pm2_5;
+    msg->data.sample.pm10 = clamp_pm(pm2_5 + (int32_t)rng_range(gen, pm2_5 + 1u));
+    return;
+  }
+
+  msg->op = (sds011_msg_op_t)rng_range(gen, 2);
+  switch (rng_range(gen, 4)) {
+    case 0:
+      msg->type = SDS011_MSG_TYPE_REP_MODE;
+      msg->data.rep_mode = (sds011_rep_mode_t)rng_range(gen, 2);
+      break;
+    case 1:
+      msg->type = SDS011_MSG_TYPE_SLEEP;
+      msg->data.sleep = (sds011_sleep_t)rng_range(gen, 2);
+      break;
+    case 2:
+      msg->type = SDS011_MSG_TYPE_OP_MODE;
+      msg->data.op_mode.interval = (uint8_t)rng_range(gen, 31);
+      msg->data.op_mode.mode = msg->data.op_mode.interval != 0 ?
+        SDS011_OP_MODE_INTERVAL : SDS011_OP_MODE_CONTINOUS;
+      break;
+    default:
+      msg->type = SDS011_MSG_TYPE_FW_VER;
+      msg->op = SDS011_MSG_OP_GET;
+      msg->data.fw_ver = (sds011_fw_ver_t) { 18, 11, 16 };
+      break;
+  }
+}
+
+// Flip a bit of the frame or truncate it, returns the new frame size
+static size_t corrupt(sds011_generator_t *gen, uint8_t *frame, size_t size) {
+  uint32_t r = rng_next(gen);
+
+  if ((r & 0x7) == 0) {
+    return 1 + rng_range(gen, (uint32_t)size - 1);
+  }
+  frame[rng_range(gen, (uint32_t)size)] ^= (uint8_t)(1u << ((r >> 8) & 0x7));
+  return size;
+}
+
+size_t sds011_generator_fill(sds011_generator_t *gen, uint8_t *buf, size_t size, uint64_t count) {
+  size_t len = 0;
+
+  if (gen == NULL || buf == NULL) {
+    return 0;
+  }
+
+  for (; count > 0 && size - len >= SDS011_REPLY_PACKET_SIZE; count--) {
+    sds011_msg_t msg;
+    random_msg(gen, &msg);
+
+    size_t bytes = sds011_builder_build_r(&msg, &buf[len], SDS011_REPLY_PACKET_SIZE, NULL);
+    if (bytes == 0) {
+      break;
+    }
+
+    gen->stats.frames++;
+    if (msg.type != SDS011_MSG_TYPE_DATA) {
+      gen->stats.replies++;
+    }
+    if (rng_range(gen, RATE_SCALE) < gen->cfg.corrupt_rate) {
+      bytes = corrupt(gen, &buf[len], bytes);
+      gen->stats.corrupted++;
+    }
+    len += bytes;
+  }
+  return len;
+}
+
+void sds011_generator_get_stats(sds011_generator_t const *gen, sds011_generator_stats_t *stats) {
+  *stats = gen->stats;
+}
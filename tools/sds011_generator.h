@@ -0,0 +1,75 @@
+#ifndef SDS011_GENERATOR_H__
+#define SDS011_GENERATOR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../src/sds011_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  SDS011_GENERATOR_PM_UNIFORM,  // pm2_5 uniform in [pm_min, pm_max]
+  SDS011_GENERATOR_PM_NORMAL,   // pm2_5 normal around pm_mean with pm_stddev
+} sds011_generator_dist_t;
+
+typedef struct {
+  uint16_t dev_id_base;           // first device id
+  uint32_t dev_count;             // number of devices, at least 1
+  sds011_generator_dist_t pm_dist;
+  uint16_t pm_min, pm_max;        // uniform distribution, 0.1 ug/m3
+  uint16_t pm_mean, pm_stddev;    // normal distribution, 0.1 ug/m3
+  uint32_t reply_rate;            // command replies (0xC5) per million frames
+  uint32_t corrupt_rate;          // corrupted frames per million frames
+  uint64_t seed;
+} sds011_generator_cfg_t;
+
+typedef struct {
+  uint64_t frames;                // frames written
+  uint64_t replies;               // command replies written
+  uint64_t corrupted;             // corrupted frames written
+} sds011_generator_stats_t;
+
+typedef struct {
+  sds011_generator_cfg_t cfg;
+  uint64_t rng;
+  sds011_generator_stats_t stats;
+} sds011_generator_t;
+
+/**
+ * Initialize generator
+ * @param[in] gen generator structure
+ * @param[in] cfg generator configuration
+ * @return SDS011_OK on success, otherwise error code
+ */
+sds011_err_t sds011_generator_init(sds011_generator_t *gen, sds011_generator_cfg_t const *cfg);
+
+/**
+ * @brief Fill the buffer with sensor frames.
+ *        Frames are sensor data replies (0xC0) of random devices, with
+ *        command replies (0xC5) and corrupted frames mixed in at the
+ *        configured rates. Frames are serialized with the sensor side
+ *        builders of sds011_builder_build_r. A corrupted frame has a bit
+ *        flipped or is truncated. Only whole frames are written.
+ * @param[in]  gen generator structure
+ * @param[out] buf output buffer
+ * @param[in]  size size of the buffer
+ * @param[in]  count maximum number of frames
+ * @return number of bytes written
+ */
+size_t sds011_generator_fill(sds011_generator_t *gen, uint8_t *buf, size_t size, uint64_t count);
+
+/**
+ * Get generator statistics
+ * @param[in]  gen generator structure
+ * @param[out] stats frames written since initialization
+ */
+void sds011_generator_get_stats(sds011_generator_t const *gen, sds011_generator_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SDS011_GENERATOR_H__